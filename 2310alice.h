@@ -1,9 +0,0 @@
-#ifndef _2310ALICE_H_
-#define _2310ALICE_H_
-
-#include "player.h"
-
-// Send a card to the game.
-Card play_card(PlayerInfo* game, bool isLead, Card lead, bool specialMove);
-
-#endif // 2310ALICE_H_
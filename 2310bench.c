@@ -0,0 +1,749 @@
+#include "2310bench.h"
+
+/* Every allocation made while a benchmark runs, including those inside
+ * the C library, goes through these. */
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t count, size_t size);
+extern void* __libc_realloc(void* pointer, size_t size);
+extern void __libc_free(void* pointer);
+
+long allocations = 0;
+volatile long sink;
+
+void* malloc(size_t size) {
+    allocations++;
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    allocations++;
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* pointer, size_t size) {
+    allocations++;
+    return __libc_realloc(pointer, size);
+}
+
+void free(void* pointer) {
+    __libc_free(pointer);
+}
+
+/**
+ * Time every primitive and write the results to a file, by default 
+ * bench_output.txt, so runs can be diffed.
+ */ 
+int main(int argc, char** argv) {
+    const Benchmark benchmarks[] = {
+            {"read_line", bench_read_line}, 
+            {"next_line", bench_next_line}, 
+            {"check_card", bench_check_card}, 
+            {"check_command", bench_check_command}, 
+            {"read_int", bench_read_int}, 
+            {"string_of", bench_string_of}, 
+            {"parse_message/HAND1000", bench_parse_hand}, 
+            {"fill_hand/1000", bench_fill_hand}, 
+            {"remove_card+add_card", bench_remove_card}, 
+            {"play_table/1000", bench_play_table}, 
+            {"reference/extremum1000", bench_reference_extremum}, 
+            {"format_message", bench_format_message}, 
+            {"encode_message/HAND1000", bench_encode_message}, 
+            {"decode_message/HAND1000", bench_decode_message}, 
+            {"log_round/1000", bench_log_round}, 
+            {"parse_text/PLAYED", bench_parse_played}, 
+            {"reference/PLAYED", bench_reference_played}, 
+            {"reference/HAND1000", bench_reference_hand}};
+    FILE* output = fopen((argc > 1) ? argv[1] : BENCH_OUTPUT, "w");
+    if (!output) {
+        fprintf(stderr, "Usage: 2310bench [output]\n");
+        return 1;
+    }
+
+    BenchInput input;
+    prepare_input(&input);
+    for (int i = 0; i < sizeof(benchmarks) / sizeof(benchmarks[0]); i++) {
+        time_benchmark(&benchmarks[i], &input, output);
+    }
+    int mismatches = check_corpus(output);
+    fclose(output);
+    return mismatches ? 1 : 0;
+}
+
+/**
+ * Build the inputs every benchmark uses.
+ * 
+ * @param input - The inputs to fill in.
+ */ 
+void prepare_input(BenchInput* input) {
+    int ranks = strlen(BENCH_RANKS);
+    int capacity = strlen(RECIEVE_HAND) + CHAR_BUFFER + 3 * BENCH_HAND;
+    input->handLine = malloc(capacity);
+    input->scratch = malloc(capacity);
+    input->handLength = sprintf(input->handLine, "%s%d", RECIEVE_HAND, 
+            BENCH_HAND);
+    for (int i = 0; i < BENCH_HAND; i++) {
+        input->cards[i] = (Card) {.suit = SUITS[i % SUIT_COUNT], 
+                .rank = BENCH_RANKS[i * 7 % ranks]};
+        input->handLength += sprintf(input->handLine + input->handLength, 
+                ",%c%c", input->cards[i].suit, input->cards[i].rank);
+    }
+    fill_hand(&input->hand, input->cards, BENCH_HAND);
+    input->player = (PlayerInfo) {.handSize = BENCH_HAND, 
+            .hand = &input->hand};
+
+    Message hand = {.type = MESSAGE_HAND, .count = BENCH_HAND, 
+            .cards = input->cards};
+    input->encoded = malloc(encoded_size(&hand));
+    input->encodedLength = encode_message(&hand, input->encoded);
+
+    // The same lines are read as a stream and through a LineReader.
+    input->stream = tmpfile();
+    for (int i = 0; i < BENCH_LINES; i++) {
+        fprintf(input->stream, "%s%d,%c%c\n", RECIEVE_PLAYED, i % 4, 
+                input->cards[i].suit, input->cards[i].rank);
+    }
+    fflush(input->stream);
+    init_reader(&input->reader, dup(fileno(input->stream)));
+    rewind(input->stream);
+}
+
+/**
+ * Run a benchmark enough times to time it reliably and report the time 
+ * and allocations of one operation.
+ * 
+ * @param benchmark - The benchmark to run.
+ * @param input - The inputs to run it on.
+ * @param output - Where to report the result.
+ */ 
+void time_benchmark(const Benchmark* benchmark, BenchInput* input, 
+        FILE* output) {
+    struct timespec start, end;
+    long elapsed = 0;
+    long count;
+
+    // Double the count until a run takes long enough.
+    for (count = 1; elapsed < BENCH_NANOS; count *= 2) {
+        allocations = 0;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        sink += benchmark->run(input, count);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        elapsed = (end.tv_sec - start.tv_sec) * 1000000000L 
+                + end.tv_nsec - start.tv_nsec;
+    }
+    count /= 2;
+
+    const char* format = "%-24s %12.1f ns/op %10.3f allocs/op %12ld ops\n";
+    fprintf(output, format, benchmark->name, (double) elapsed / count, 
+            (double) allocations / count, count);
+    printf(format, benchmark->name, (double) elapsed / count, 
+            (double) allocations / count, count);
+}
+
+/**
+ * Read PLAYED lines from a stream with read_line.
+ */ 
+long bench_read_line(BenchInput* input, long count) {
+    long total = 0;
+    char* line;
+    for (long i = 0; i < count; i++) {
+        if (!read_line(input->stream, &line)) {
+            rewind(input->stream);
+            read_line(input->stream, &line);
+        }
+        total += line[strlen(RECIEVE_PLAYED)];
+        free(line);
+    }
+    return total;
+}
+
+/**
+ * Read PLAYED lines from a file with a LineReader.
+ */ 
+long bench_next_line(BenchInput* input, long count) {
+    long total = 0;
+    char* line;
+    for (long i = 0; i < count; i++) {
+        if (!(line = next_line(&input->reader))) {
+            lseek(input->reader.fd, 0, SEEK_SET);
+            input->reader.eof = false;
+            line = next_line(&input->reader);
+        }
+        total += line[strlen(RECIEVE_PLAYED)];
+    }
+    return total;
+}
+
+/**
+ * Check cards as they arrive in PLAY messages.
+ */ 
+long bench_check_card(BenchInput* input, long count) {
+    long total = 0;
+    char card[] = "Sf";
+    for (long i = 0; i < count; i++) {
+        card[0] = input->cards[i % BENCH_HAND].suit;
+        total += check_card(card);
+    }
+    return total;
+}
+
+/**
+ * Match a NEWROUND line against each command, as the player does.
+ */ 
+long bench_check_command(BenchInput* input, long count) {
+    long total = 0;
+    char line[] = "NEWROUND3";
+    for (long i = 0; i < count; i++) {
+        total += !check_command(line, RECIEVE_NEWGAME, false) 
+                + !check_command(line, RECIEVE_NEWROUND, false);
+    }
+    return total;
+}
+
+/**
+ * Read the numbers found in messages and arguments.
+ */ 
+long bench_read_int(BenchInput* input, long count) {
+    long total = 0;
+    char number[] = "1000";
+    for (long i = 0; i < count; i++) {
+        total += read_int(number);
+    }
+    return total;
+}
+
+/**
+ * Turn player numbers into arguments.
+ */ 
+long bench_string_of(BenchInput* input, long count) {
+    long total = 0;
+    char* line;
+    for (long i = 0; i < count; i++) {
+        total += string_of(i % BENCH_HAND, &line)[0];
+        free(line);
+    }
+    return total;
+}
+
+/**
+ * Parse a long HAND line as the player does.
+ */ 
+long bench_parse_hand(BenchInput* input, long count) {
+    long total = 0;
+    Message message;
+    for (long i = 0; i < count; i++) {
+        parse_message(&input->player, input->handLine, &message);
+        total += message.cards[i % BENCH_HAND].rank;
+        free(message.cards);
+    }
+    return total;
+}
+
+/**
+ * Turn a long hand into a Hand.
+ */ 
+long bench_fill_hand(BenchInput* input, long count) {
+    long total = 0;
+    Hand hand;
+    for (long i = 0; i < count; i++) {
+        fill_hand(&hand, input->cards, BENCH_HAND);
+        total += hand.suits[i % SUIT_COUNT];
+    }
+    return total;
+}
+
+/**
+ * Play a card from a long hand, then put it back.
+ */ 
+long bench_remove_card(BenchInput* input, long count) {
+    long total = 0;
+    for (long i = 0; i < count; i++) {
+        Card card = input->cards[i % BENCH_HAND];
+        total += remove_card(&input->hand, card);
+        add_card(&input->hand, card);
+    }
+    return total;
+}
+
+/**
+ * Choose a card from a long hand as alice does, leading and discarding.
+ */ 
+long bench_play_table(BenchInput* input, long count) {
+    long total = 0;
+    Card lead = {.suit = 'S', .rank = '1'};
+    for (long i = 0; i < count; i++) {
+        total += play_table(&aliceTable, &input->hand, i % 2, lead, 
+                false).rank;
+    }
+    return total;
+}
+
+/**
+ * Choose a card from a long hand as players did before strategies were 
+ * tables, alternating the comparison.
+ */ 
+long bench_reference_extremum(BenchInput* input, long count) {
+    long total = 0;
+    char order[SUIT_COUNT] = {'S', 'C', 'D', 'H'};
+    for (long i = 0; i < count; i++) {
+        total += reference_extremum(&input->hand, BENCH_HAND, 
+                (i % 2) ? reference_max : reference_min, order).rank;
+    }
+    return total;
+}
+
+/**
+ * Format the PLAYED messages the hub broadcasts.
+ */ 
+long bench_format_message(BenchInput* input, long count) {
+    long total = 0;
+    char buffer[CHAR_BUFFER];
+    for (long i = 0; i < count; i++) {
+        total += format_message(&(Message) {.type = MESSAGE_PLAYED, 
+                .player = i % 4, .card = input->cards[i % BENCH_HAND]}, 
+                buffer, CHAR_BUFFER);
+    }
+    return total;
+}
+
+/**
+ * Encode a long hand as a binary HAND message.
+ */ 
+long bench_encode_message(BenchInput* input, long count) {
+    long total = 0;
+    Message hand = {.type = MESSAGE_HAND, .count = BENCH_HAND, 
+            .cards = input->cards};
+    for (long i = 0; i < count; i++) {
+        total += encode_message(&hand, (unsigned char*) input->scratch);
+    }
+    return total;
+}
+
+/**
+ * Decode a long binary HAND message.
+ */ 
+long bench_decode_message(BenchInput* input, long count) {
+    long total = 0;
+    Message message;
+    for (long i = 0; i < count; i++) {
+        total += decode_message(input->encoded, input->encodedLength, 
+                &message);
+        free(message.cards);
+    }
+    return total;
+}
+
+/**
+ * Log a round of a thousand cards, as a player does for every round. The 
+ * sink is emptied instead of written out.
+ */ 
+long bench_log_round(BenchInput* input, long count) {
+    long total = 0;
+    for (long i = 0; i < count; i++) {
+        log_round(i % 4, input->cards, BENCH_HAND);
+        total += playerLog.text.length;
+        playerLog.text.length = 0;
+    }
+    return total;
+}
+
+/**
+ * Parse PLAYED lines with the table driven parser.
+ */ 
+long bench_parse_played(BenchInput* input, long count) {
+    long total = 0;
+    Message message;
+    char line[] = "PLAYED3,Sf";
+    for (long i = 0; i < count; i++) {
+        line[strlen(RECIEVE_PLAYED)] = '0' + i % 4;
+        parse_text(line, &message);
+        total += message.player + message.card.rank;
+    }
+    return total;
+}
+
+/**
+ * Parse PLAYED lines as players did before parse_text. The line is copied 
+ * first because parsing splits it up.
+ */ 
+long bench_reference_played(BenchInput* input, long count) {
+    long total = 0;
+    Message message;
+    char line[] = "PLAYED3,Sf";
+    for (long i = 0; i < count; i++) {
+        line[strlen(RECIEVE_PLAYED)] = '0' + i % 4;
+        memcpy(input->scratch, line, sizeof(line));
+        reference_message(input->scratch, BENCH_HAND, &message);
+        total += message.player + message.card.rank;
+    }
+    return total;
+}
+
+/**
+ * Parse a long HAND line as players did before parse_text.
+ */ 
+long bench_reference_hand(BenchInput* input, long count) {
+    long total = 0;
+    Message message;
+    for (long i = 0; i < count; i++) {
+        memcpy(input->scratch, input->handLine, input->handLength + 1);
+        reference_message(input->scratch, BENCH_HAND, &message);
+        total += message.cards[i % BENCH_HAND].rank;
+        free(message.cards);
+    }
+    return total;
+}
+
+/**
+ * Check parse_text, read_int and check_card against the code they replaced 
+ * on a generated corpus of valid, mutated and random lines. The only 
+ * difference allowed is that a HAND line one card short is now refused, 
+ * where the player used to accept it and play a card it never read.
+ * 
+ * @param output - Where to report the result.
+ * @return The number of lines the two disagreed on.
+ */ 
+int check_corpus(FILE* output) {
+    uint64_t state = CORPUS_SEED;
+    char line[CORPUS_LENGTH + 1];
+    char scratch[CORPUS_LENGTH + 1];
+    int counts[REFERENCE_SHORT + 2] = {0};
+
+    for (int i = 0; i < CORPUS_LINES; i++) {
+        corpus_line(&state, line);
+        int result = compare_line(line, scratch);
+        counts[result]++;
+        if (result > REFERENCE_SHORT) {
+            fprintf(stderr, "Mismatch: \"%s\"\n", line);
+        }
+    }
+
+    const char* format = "%-24s %12d lines %10d accepted %6d short %6d "
+            "mismatched\n";
+    fprintf(output, format, "parse_text/corpus", CORPUS_LINES, 
+            counts[REFERENCE_ACCEPT], counts[REFERENCE_SHORT], 
+            counts[REFERENCE_SHORT + 1]);
+    printf(format, "parse_text/corpus", CORPUS_LINES, 
+            counts[REFERENCE_ACCEPT], counts[REFERENCE_SHORT], 
+            counts[REFERENCE_SHORT + 1]);
+    return counts[REFERENCE_SHORT + 1];
+}
+
+/**
+ * Compare how one line is read by the player, by the hub and as a number 
+ * or card, before and after parse_text.
+ * 
+ * @param line - The line.
+ * @param scratch - Room to copy the line into for the old parsers.
+ * @return What the player made of it before, as REFERENCE_ACCEPT, 
+ *      REFERENCE_REJECT or REFERENCE_SHORT, or REFERENCE_SHORT + 1 if 
+ *      anything disagreed.
+ */ 
+int compare_line(const char* line, char* scratch) {
+    Message old = {.cards = NULL};
+    Message new = {.cards = NULL};
+    Card oldCard;
+    bool same = true;
+
+    strcpy(scratch, line);
+    same &= reference_read_int(scratch) == read_int(scratch);
+    same &= reference_check_card(scratch) == check_card(scratch);
+
+    strcpy(scratch, line);
+    bool oldPlay = reference_play(scratch, &oldCard);
+    bool newPlay = parse_text(line, &new) == MESSAGE_PLAY;
+    same &= oldPlay == newPlay && (!oldPlay || (oldCard.suit 
+            == new.card.suit && oldCard.rank == new.card.rank));
+
+    strcpy(scratch, line);
+    int result = reference_message(scratch, CORPUS_HAND, &old);
+    MessageType type = parse_text(line, &new);
+    bool accepted = type == MESSAGE_GAMEOVER || type == MESSAGE_NEWGAME 
+            || type == MESSAGE_NEWROUND || type == MESSAGE_PLAYED 
+            || (type == MESSAGE_HAND && new.count == CORPUS_HAND);
+    if (result == REFERENCE_SHORT) {
+        same &= !accepted;
+    } else if (result == REFERENCE_REJECT || !accepted) {
+        same &= result == REFERENCE_REJECT && !accepted;
+    } else {
+        same &= old.type == type;
+        same &= (type != MESSAGE_NEWROUND && type != MESSAGE_PLAYED) 
+                || old.player == new.player;
+        same &= (type != MESSAGE_NEWGAME && type != MESSAGE_HAND) 
+                || old.count == new.count;
+        same &= type != MESSAGE_PLAYED || (old.card.suit == new.card.suit 
+                && old.card.rank == new.card.rank);
+        same &= type != MESSAGE_HAND 
+                || !memcmp(old.cards, new.cards, sizeof(Card) * new.count);
+    }
+    if (type == MESSAGE_HAND) {
+        free(new.cards);
+    }
+    if (old.type == MESSAGE_HAND && result != REFERENCE_REJECT) {
+        free(old.cards);
+    }
+    return same ? result : REFERENCE_SHORT + 1;
+}
+
+/**
+ * Make a line for the corpus: a valid message of any type, or random 
+ * bytes, then changed a few times by replacing, inserting or deleting a 
+ * byte, cutting the line short or adding a number near a limit.
+ * 
+ * @param state - The state of the random numbers.
+ * @param line - Where to write the line, with room for CORPUS_LENGTH.
+ */ 
+void corpus_line(uint64_t* state, char* line) {
+    const char* numbers[] = {"0", "-1", "+2", " 3", "4294967297", 
+            "2147483648", "9223372036854775807", "9223372036854775808", 
+            "-9223372036854775809", "99999999999999999999", ""};
+    int bytes = strlen(CORPUS_BYTES);
+    int player = next_random(state) % 6;
+    Card cards[CORPUS_HAND];
+    for (int i = 0; i < CORPUS_HAND; i++) {
+        cards[i] = (Card) {.suit = SUITS[next_random(state) % SUIT_COUNT], 
+                .rank = BENCH_RANKS[next_random(state)
+                % strlen(BENCH_RANKS)]};
+    }
+
+    switch (next_random(state) % 7) {
+        case 0:
+            sprintf(line, "%s%d", RECIEVE_NEWROUND, player);
+            break;
+        case 1:
+            sprintf(line, "%s%d", RECIEVE_NEWGAME, player);
+            break;
+        case 2:
+            sprintf(line, "%s%d,%c%c", RECIEVE_PLAYED, player, 
+                    cards[0].suit, cards[0].rank);
+            break;
+        case 3:
+            sprintf(line, "%s%d,%c%c,%c%c,%c%c", RECIEVE_HAND, CORPUS_HAND, 
+                    cards[0].suit, cards[0].rank, cards[1].suit, 
+                    cards[1].rank, cards[2].suit, cards[2].rank);
+            break;
+        case 4:
+            sprintf(line, "%s%c%c", SEND_PLAY, cards[0].suit, cards[0].rank);
+            break;
+        case 5:
+            strcpy(line, RECIEVE_GAMEOVER);
+            break;
+        default:
+            line[0] = '\0';
+            for (int i = next_random(state) % 16; i > 0; i--) {
+                strncat(line, &CORPUS_BYTES[next_random(state) % bytes], 1);
+            }
+    }
+
+    for (int i = next_random(state) % (CORPUS_MUTATIONS + 1); i > 0; i--) {
+        int length = strlen(line);
+        int at = length ? next_random(state) % (length + 1) : 0;
+        char byte = CORPUS_BYTES[next_random(state) % bytes];
+        const char* number = numbers[next_random(state)
+                % (sizeof(numbers) / sizeof(numbers[0]))];
+        switch (next_random(state) % 5) {
+            case 0:
+                if (at < length) {
+                    line[at] = byte;
+                }
+                break;
+            case 1:
+                if (length < CORPUS_LENGTH) {
+                    memmove(line + at + 1, line + at, length - at + 1);
+                    line[at] = byte;
+                }
+                break;
+            case 2:
+                if (at < length) {
+                    memmove(line + at, line + at + 1, length - at);
+                }
+                break;
+            case 3:
+                line[at] = '\0';
+                break;
+            default:
+                if (length + strlen(number) <= CORPUS_LENGTH) {
+                    memmove(line + at + strlen(number), line + at, 
+                            length - at + 1);
+                    memcpy(line + at, number, strlen(number));
+                }
+        }
+    }
+}
+
+/**
+ * Step a xorshift generator, so the corpus is the same on every run.
+ * 
+ * @param state - The state of the generator, not zero.
+ * @return The next number.
+ */ 
+uint64_t next_random(uint64_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+/**
+ * Read an integer with strtol, as read_int did.
+ */ 
+int reference_read_int(char* line) {
+    if (line == NULL) {
+        return -1;
+    }
+    char* error;
+    int num;
+    num = strtol(line, &error, BASE);
+    if (strlen(error) > 0) {
+        // Any non-integer characters read
+        return -1;
+    }
+    return num;
+}
+
+/**
+ * Check a card, as check_card did.
+ */ 
+bool reference_check_card(char* card) {
+    if (strlen(card) != 2 || (card[0] != 'D' && card[0] != 'H' 
+            && card[0] != 'C' && card[0] != 'S') 
+            || (card[1] < '1' || (card[1] > '9' 
+            && card[1] < 'a') || card[1] > 'f')) {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Read a line from the hub as a player did, splitting it up with strtok. 
+ * Where the player used to exit, this rejects.
+ * 
+ * @param line - The line, which is changed.
+ * @param handSize - The hand the player expects.
+ * @param message - Set to the message.
+ * @return REFERENCE_ACCEPT, REFERENCE_REJECT, or REFERENCE_SHORT for a 
+ *      hand one card short, which was accepted with its last card unset.
+ */ 
+int reference_message(char* line, int handSize, Message* message) {
+    char* newCard;
+    if (!strcmp(line, RECIEVE_GAMEOVER)) {
+        message->type = MESSAGE_GAMEOVER;
+        return REFERENCE_ACCEPT;
+
+    } else if (!check_command(line, RECIEVE_NEWGAME, false)) {
+        message->type = MESSAGE_NEWGAME;
+        message->count = reference_read_int(line + strlen(RECIEVE_NEWGAME));
+
+    } else if (!check_command(line, RECIEVE_NEWROUND, false)) {
+        message->type = MESSAGE_NEWROUND;
+        message->player = reference_read_int(strtok(line, RECIEVE_NEWROUND));
+
+    } else if (!check_command(line, RECIEVE_PLAYED, false)) {
+        message->type = MESSAGE_PLAYED;
+        message->player = reference_read_int(strtok(line 
+                + strlen(RECIEVE_PLAYED), ","));
+        if ((newCard = strtok(NULL, ",")) == NULL 
+                || !reference_check_card(newCard)) {
+            return REFERENCE_REJECT;
+        }
+        message->card = (Card) {.suit = newCard[0], .rank = newCard[1]};
+
+    } else if (!check_command(line, RECIEVE_HAND, false)) {
+        message->type = MESSAGE_HAND;
+        message->count = handSize;
+        int tempCount = 0;
+        int cardCount = reference_read_int(strtok(line 
+                + strlen(RECIEVE_HAND), ","));
+        if (cardCount < 1 || cardCount != handSize) {
+            return REFERENCE_REJECT;
+        }
+        message->cards = malloc(sizeof(Card) * cardCount);
+        char* currentCard;
+        while ((currentCard = strtok(NULL, ",")) != NULL) {
+            if (tempCount == cardCount 
+                    || !reference_check_card(currentCard)) {
+                free(message->cards);
+                return REFERENCE_REJECT;
+            }
+            message->cards[tempCount++] = (Card) {.suit = currentCard[0], 
+                    .rank = currentCard[1]};
+        }
+        if (tempCount < cardCount - 1) {
+            free(message->cards);
+            return REFERENCE_REJECT;
+        }
+        return (tempCount < cardCount) ? REFERENCE_SHORT : REFERENCE_ACCEPT;
+
+    } else {
+        return REFERENCE_REJECT;
+    }
+    return REFERENCE_ACCEPT;
+}
+
+/**
+ * Read a PLAY line as the hub did.
+ * 
+ * @param line - The line.
+ * @param card - Set to the card played.
+ * @return Whether the line was valid.
+ */ 
+bool reference_play(char* line, Card* card) {
+    if (check_command(line, SEND_PLAY, false) 
+            || !reference_check_card(line += strlen(SEND_PLAY))) {
+        return false;
+    }
+    *card = (Card) {.suit = line[0], .rank = line[1]};
+    return true;
+}
+
+/**
+ * Find the largest card in a hand given an order, as players did before 
+ * strategies were tables.
+ * 
+ * @param hand - The cards held.
+ * @param handSize - The number of cards in the hand.
+ * @param compRank - A function to compare two cards.
+ * @param order - A specific order of cards to follow.
+ */ 
+Card reference_extremum(Hand* hand, int handSize, 
+        int (*compRank)(int, int), char* order) {
+    Card extremum = (Card) {.suit = DORMANT_CHAR, .rank = DORMANT_CHAR};
+    for (int i = 0; i < SUIT_COUNT && handSize > 0; i++) {
+        int suit = suit_index(order[i]);
+        // The usual comparisons are a single bit scan.
+        if (compRank == reference_max) {
+            if (highest_card(hand, order[i], &extremum)) {
+                break;
+            }
+        } else if (compRank == reference_min) {
+            if (lowest_card(hand, order[i], &extremum)) {
+                break;
+            }
+        } else if (suit != -1 && hand->suits[suit]) {
+            for (int rank = 1; rank < RANK_COUNT; rank++) {
+                Card card;
+                if ((hand->suits[suit] & 1 << rank) 
+                        && decode_card(suit << 4 | rank, &card) 
+                        && (extremum.suit == DORMANT_CHAR 
+                        || compRank(card.rank, extremum.rank))) {
+                    extremum = card;
+                }
+            }
+            break;
+        }
+    }
+    return extremum;
+}
+
+/**
+ * Find a maximum of two ints.
+ */ 
+int reference_max(int o1, int o2) {
+    return o1 > o2;
+}
+
+/**
+ * Find a minimum of two ints.
+ */ 
+int reference_min(int o1, int o2) {
+    return o1 < o2;
+}
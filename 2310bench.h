@@ -0,0 +1,106 @@
+#ifndef _2310BENCH_H_
+#define _2310BENCH_H_
+
+#include <time.h>
+#include "player.h"
+
+#define BENCH_OUTPUT "bench_output.txt"
+#define BENCH_NANOS 200000000L
+#define BENCH_HAND 1000
+#define BENCH_LINES 1000
+#define BENCH_RANKS "123456789abcdef"
+
+#define CORPUS_LINES 500000
+#define CORPUS_SEED 2310
+#define CORPUS_HAND 3
+#define CORPUS_LENGTH 96
+#define CORPUS_MUTATIONS 4
+#define CORPUS_BYTES "NEWROUDGAMPLYH0123456789abcdefSCDx+-, \t\r\v\x7f\xff"
+
+#define REFERENCE_REJECT 0
+#define REFERENCE_ACCEPT 1
+#define REFERENCE_SHORT 2
+
+/**
+ * Inputs prepared once and shared by every benchmark.
+ * 
+ * @param cards - A long hand of cards
+ * @param handLine - The HAND line of the cards
+ * @param handLength - The length of the HAND line
+ * @param scratch - Room to copy a line into before it is split up
+ * @param stream - Many PLAYED lines, for read_line
+ * @param reader - The same lines, for a LineReader
+ * @param hand - The cards as a Hand
+ * @param player - A player expecting the long hand
+ * @param encoded - The hand as a binary HAND message
+ * @param encodedLength - The length of the binary message
+ */ 
+typedef struct {
+    Card cards[BENCH_HAND];
+    char* handLine;
+    int handLength;
+    char* scratch;
+    FILE* stream;
+    LineReader reader;
+    Hand hand;
+    PlayerInfo player;
+    unsigned char* encoded;
+    int encodedLength;
+} BenchInput;
+
+/**
+ * A primitive to time. It performs count operations and returns something 
+ * depending on every result, so none can be optimised away.
+ * 
+ * @param name - What is timed
+ * @param run - Perform the operations
+ */ 
+typedef struct {
+    const char* name;
+    long (*run)(BenchInput* input, long count);
+} Benchmark;
+
+/* Harness */
+void prepare_input(BenchInput* input);
+void time_benchmark(const Benchmark* benchmark, BenchInput* input, 
+        FILE* output);
+
+/* Benchmarks */
+long bench_read_line(BenchInput* input, long count);
+long bench_next_line(BenchInput* input, long count);
+long bench_check_card(BenchInput* input, long count);
+long bench_check_command(BenchInput* input, long count);
+long bench_read_int(BenchInput* input, long count);
+long bench_string_of(BenchInput* input, long count);
+long bench_parse_hand(BenchInput* input, long count);
+long bench_fill_hand(BenchInput* input, long count);
+long bench_remove_card(BenchInput* input, long count);
+long bench_play_table(BenchInput* input, long count);
+long bench_reference_extremum(BenchInput* input, long count);
+long bench_format_message(BenchInput* input, long count);
+long bench_encode_message(BenchInput* input, long count);
+long bench_decode_message(BenchInput* input, long count);
+long bench_log_round(BenchInput* input, long count);
+long bench_parse_played(BenchInput* input, long count);
+long bench_reference_played(BenchInput* input, long count);
+long bench_reference_hand(BenchInput* input, long count);
+
+/* Differential corpus */
+int check_corpus(FILE* output);
+int compare_line(const char* line, char* scratch);
+void corpus_line(uint64_t* state, char* line);
+uint64_t next_random(uint64_t* state);
+
+/* The text parsers parse_text replaced, kept to compare it against */
+int reference_read_int(char* line);
+bool reference_check_card(char* card);
+int reference_message(char* line, int handSize, Message* message);
+bool reference_play(char* line, Card* card);
+
+/* How players chose cards before strategies were tables */
+Card reference_extremum(Hand* hand, int handSize, 
+        int (*compRank)(int, int), char* order);
+int reference_max(int o1, int o2);
+int reference_min(int o1, int o2);
+
+#endif // _2310BENCH_H_
@@ -0,0 +1,170 @@
+#include "2310eval.h"
+
+/**
+ * Play a pairing of in-process strategies over many random deals and 
+ * report how each seat did.
+ */ 
+int main(int argc, char** argv) {
+    EvalOptions options;
+    int first = parse_eval_options(&options, argc, argv);
+
+    // Shift the arguments so the threshold is always argv[1].
+    argc -= first - 1;
+    argv += first - 1;
+    if (argc < EVAL_ARGS + 1) {
+        exit_eval(ERROR_INCORRECT_ARGS);
+    }
+
+    HubInfo game = {.playerCount = argc - 2, .report = NULL};
+    if ((game.threshold = read_int(argv[1])) < 2) {
+        exit_eval(ERROR_INVALID_THRESHOLD);
+    }
+    Strategy strategies[game.playerCount];
+    for (int i = 0; i < game.playerCount; i++) {
+        if (!find_strategy(argv[i + 2], &strategies[i]) 
+                || !strategies[i].play) {
+            exit_eval(ERROR_PLAYER);
+        }
+    }
+
+    DeckSet decks;
+    if (!generate_decks(options.spec, options.games, options.seed, 
+            &decks)) {
+        exit_eval(ERROR_DECK);
+    }
+    int jobs = options.jobs ? options.jobs : sysconf(_SC_NPROCESSORS_ONLN);
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int status = run_parallel(&game, strategies, &decks, jobs, NULL);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    free_decks(&decks);
+    if (status != NORMAL_EXIT) {
+        exit_eval(status);
+    }
+
+    double seconds = (end.tv_sec - start.tv_sec) 
+            + (end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("Games=%d Time=%.3f Rate=%.1f\n", game.games, seconds, 
+            (seconds > 0) ? game.games / seconds : 0);
+    for (int i = 0; i < game.playerCount; i++) {
+        output_seat(&game, i, argv[i + 2]);
+    }
+    exit_eval(NORMAL_EXIT);
+}
+
+/**
+ * Read the options preceding the threshold argument.
+ *
+ * @param options - The options to fill in.
+ * @param argc - The number of arguments.
+ * @param argv - A list of command line arguments.
+ * @return The index of the first positional argument.
+ */ 
+int parse_eval_options(EvalOptions* options, int argc, char** argv) {
+    const struct option longOptions[] = {
+            {"games", required_argument, NULL, 'n'},
+            {"seed", required_argument, NULL, 's'},
+            {"jobs", required_argument, NULL, 'j'},
+            {"deck", required_argument, NULL, 'd'},
+            {NULL, 0, NULL, 0}};
+    int option;
+    char* end;
+
+    *options = (EvalOptions) {.games = DEFAULT_GAMES, .seed = 0, 
+            .jobs = 0, .spec = DEFAULT_SPEC};
+    opterr = 0;
+    while ((option = getopt_long(argc, argv, EVAL_OPTIONS, 
+            longOptions, NULL)) != -1) {
+        switch (option) {
+            case 'n':
+                if ((options->games = read_int(optarg)) < 1) {
+                    exit_eval(ERROR_INCORRECT_ARGS);
+                }
+                break;
+            case 's':
+                errno = 0;
+                options->seed = strtoull(optarg, &end, 0);
+                if (errno || end == optarg || *end || *optarg == '-') {
+                    exit_eval(ERROR_INCORRECT_ARGS);
+                }
+                break;
+            case 'j':
+                if ((options->jobs = read_int(optarg)) < 0) {
+                    exit_eval(ERROR_INCORRECT_ARGS);
+                }
+                break;
+            case 'd':
+                options->spec = optarg;
+                break;
+            default:
+                exit_eval(ERROR_INCORRECT_ARGS);
+        }
+    }
+    return optind;
+}
+
+/**
+ * Print an estimate with its 95% confidence interval.
+ *
+ * @param name - What is estimated.
+ * @param estimate - The estimate.
+ * @param low - The bottom of the interval.
+ * @param high - The top of the interval.
+ */ 
+void output_interval(const char* name, double estimate, double low, 
+        double high) {
+    printf(" %s=%.4f [%.4f, %.4f]", name, estimate, low, high);
+}
+
+/**
+ * Print the mean score and win rate of a seat. The mean uses the normal 
+ * interval of the sample variance, the win rate the Wilson interval, which 
+ * stays inside [0, 1] even for rare wins. The Wilson interval is centred 
+ * away from the observed rate, so it is printed as its bounds.
+ *
+ * @param game - The merged results of every game.
+ * @param seat - The seat to report.
+ * @param name - The strategy in the seat.
+ */ 
+void output_seat(HubInfo* game, int seat, const char* name) {
+    Player* player = &game->players[seat];
+    double count = game->games;
+    double z = CONFIDENCE_Z;
+
+    double mean = player->totalScore / count;
+    double variance = (count > 1) ? (player->squaredScore 
+            - count * mean * mean) / (count - 1) : 0;
+    double meanWidth = z * sqrt(fmax(variance, 0) / count);
+
+    double rate = player->wins / count;
+    double scale = 1 + z * z / count;
+    double centre = (rate + z * z / (2 * count)) / scale;
+    double rateWidth = z * sqrt(rate * (1 - rate) / count 
+            + z * z / (4 * count * count)) / scale;
+
+    printf("Player %d %s", seat, name);
+    output_interval("Mean", mean, mean - meanWidth, mean + meanWidth);
+    output_interval("Win", rate, centre - rateWidth, centre + rateWidth);
+    printf("\n");
+}
+
+/* Exits the evaluator with specifid error Code
+ *
+ * @param exitCode - what to exit with
+ */
+void exit_eval(int exitCondition) {
+    const char* messages[] = {"",
+            "Usage: 2310eval [-n games] [-s seed] [-j jobs] [-d deck] "
+            "threshold player0 {player1}\n",
+            "Invalid threshold\n",
+            "Deck error\n",
+            "Not enough cards\n",
+            "Player error\n",
+            "Player EOF\n",
+            "Invalid message\n",
+            "Invalid card choice\n",
+            "Ended due to signal\n"};
+    fputs(messages[exitCondition], stderr);
+    exit(exitCondition);
+}
@@ -0,0 +1,37 @@
+#ifndef _2310EVAL_H_
+#define _2310EVAL_H_
+
+#include <math.h>
+#include <getopt.h>
+#include <time.h>
+#include "game.h"
+#include "runner.h"
+
+#define EVAL_OPTIONS "+n:s:j:d:"
+#define EVAL_ARGS 3
+#define DEFAULT_GAMES 100000
+#define DEFAULT_SPEC "DHCS:123456789abcdef"
+#define CONFIDENCE_Z 1.96
+
+/**
+ * Command line options of the evaluator.
+ *
+ * @param games - The number of random deals to play
+ * @param seed - The seed the deals are shuffled from
+ * @param jobs - Worker threads, or 0 for one per core
+ * @param spec - The cards in every deck, as generate_decks reads them
+ */ 
+typedef struct {
+    int games;
+    uint64_t seed;
+    int jobs;
+    const char* spec;
+} EvalOptions;
+
+int parse_eval_options(EvalOptions* options, int argc, char** argv);
+void output_interval(const char* name, double estimate, double low, 
+        double high);
+void output_seat(HubInfo* game, int seat, const char* name);
+void exit_eval(int exitCondition);
+
+#endif // _2310EVAL_H_
@@ -1,182 +1,381 @@
 #include "2310hub.h"
-
-/* Reference to all player process ID's. */
-pid_t* processes;
-// Necessary to kill processes in the signal handler.
+#include "runner.h"
+#include "server.h"
+#include "pool.h"
 
 int main(int argc, char** argv) {
-    if (argc <= EXPECTED_HUB_ARGS) {
+    HubOptions options;
+    int first = parse_options(&options, argc, argv);
+
+    // Shift the arguments so the deck is always argv[1].
+    argc -= first - 1;
+    argv += first - 1;
+    // A server is given the number of seats at a table instead of players.
+    if (options.servePath ? argc != SERVE_ARGS || options.jobs >= 0 
+            || options.ring || options.mailboxes || options.metricsPath 
+            || options.logPath || options.format != REPORT_TEXT 
+            || options.errorPath || options.keepKib || options.pool 
+            : argc <= EXPECTED_HUB_ARGS || (options.pool && options.ring)) {
         exit_game(ERROR_INCORRECT_ARGS);
     }
 
-    HubInfo game;
+    HubInfo game = {.games = 0, .metrics = NULL, .log = NULL, .ring = NULL, 
+            .piped = 0, .mailboxes = options.mailboxes, .pool = NULL};
 
     if ((game.threshold = read_int(argv[2])) < 2) {
         exit_game(ERROR_INVALID_THRESHOLD);
     }
 
     game.playerCount = argc - NON_PLAYER_ARGS;
+    game.binary = options.binary;
+    game.capturePath = options.errorPath;
+    game.captureSize = options.keepKib * KIB;
+    if (options.servePath) {
+        if ((game.playerCount = read_int(argv[3])) < 2) {
+            exit_game(ERROR_INCORRECT_ARGS);
+        }
+        run_server(&game, argv, &options);
+    }
+
+    // The players start up while the decks and everything else are set up.
+    PlayerPool pool;
+    if (options.pool && options.jobs < 0) {
+        fill_pool(&pool, argv + NON_PLAYER_ARGS, game.playerCount);
+        game.pool = &pool;
+    }
+
+    Report report;
+    open_report(&report, options.format, STDOUT_FILENO);
+    game.report = &report;
+
+    EventLoop events;
+    if (!init_loop(&events, options.stallMillis)) {
+        exit_game(ERROR_PLAYER);
+    }
+    game.events = &events;
+
+    GameLog log;
+    if (options.logPath) {
+        if (!open_log(&log, options.logPath) || !log_seating(&log, 
+                game.threshold, game.playerCount, argv + 3)) {
+            exit_game(ERROR_INCORRECT_ARGS);
+        }
+        game.log = &log;
+    }
+
+    Metrics metrics;
+    if (options.metricsPath && options.jobs < 0) {
+        start_metrics(&game, &metrics, options.metricsPath);
+    }
 
-    // GLOBAL VARAIBLES.
-    processes = malloc(sizeof(pid_t) * (game.playerCount + 1));
-    for (int i = 0; i <= game.playerCount; i++) {
-        processes[i] = -1;
+    Ring ring;
+    if (options.ring && options.jobs < 0) {
+        if (!create_ring(&ring, game.playerCount)) {
+            exit_game(ERROR_PLAYER);
+        }
+        game.ring = &ring;
     }
 
-    parse_deck(&game, argv[1]);
+    if (options.jobs >= 0) {
+        // No player processes to end.
+        run_parallel_games(&game, argv, &options);
+        exit_game(NORMAL_EXIT);
+    } else if (options.tournament || options.games) {
+        run_tournament(&game, argv, &options);
+    } else {
+        parse_deck(&game, argv[1]);
 
-    init_players(&game, argv);
+        init_players(&game, argv);
 
-    run_game(&game);
+        check_game(&game, run_game(&game));
+        game.games = 1;
+    }
 
     end_players(&game);
+    if (game.metrics) {
+        write_metrics(&game);
+    }
 
     exit_game(NORMAL_EXIT);
 }
 
 /**
- * Tick each round over and send output to the players / terminal.
+ * Read the options preceding the deck argument.
  *
- * @param game - Information about the game state.
+ * @param options - The options to fill in.
+ * @param argc - The number of arguments.
+ * @param argv - A list of command line arguments.
+ * @return The index of the first positional argument.
  */ 
-void run_game(HubInfo* game) {
-    // run through each round.
-    int lead = 0;
-    while (game->round-- > 0) {
-        lead = play_round(game, lead);
+int parse_options(HubOptions* options, int argc, char** argv) {
+    const struct option longOptions[] = {
+            {"tournament", no_argument, NULL, 't'},
+            {"jobs", required_argument, NULL, 'j'},
+            {"warn-slow", required_argument, NULL, 'w'},
+            {"binary", no_argument, NULL, 'b'},
+            {"games", required_argument, NULL, 'n'},
+            {"seed", required_argument, NULL, 's'},
+            {"metrics", required_argument, NULL, 'm'},
+            {"log", required_argument, NULL, 'l'},
+            {"ring", no_argument, NULL, 'r'},
+            {"futex", no_argument, NULL, 'f'},
+            {"serve", required_argument, NULL, 'S'},
+            {"output", required_argument, NULL, 'o'},
+            {"errors", required_argument, NULL, 'e'},
+            {"keep-errors", required_argument, NULL, 'k'},
+            {"pool", no_argument, NULL, 'p'},
+            {NULL, 0, NULL, 0}};
+    int option;
+    char* end;
+
+    options->tournament = false;
+    options->jobs = -1;
+    options->stallMillis = NO_STALL;
+    options->binary = false;
+    options->games = 0;
+    options->seed = 0;
+    options->metricsPath = NULL;
+    options->logPath = NULL;
+    options->ring = false;
+    options->mailboxes = false;
+    options->servePath = NULL;
+    options->format = REPORT_TEXT;
+    options->errorPath = NULL;
+    options->keepKib = 0;
+    options->pool = false;
+    opterr = 0;
+    while ((option = getopt_long(argc, argv, HUB_OPTIONS, 
+            longOptions, NULL)) != -1) {
+        switch (option) {
+            case 't':
+                options->tournament = true;
+                break;
+            case 'j':
+                // Zero uses one worker per core.
+                if ((options->jobs = read_int(optarg)) < 0) {
+                    exit_game(ERROR_INCORRECT_ARGS);
+                }
+                break;
+            case 'b':
+                options->binary = true;
+                break;
+            case 'r':
+                options->ring = true;
+                break;
+            case 'f':
+                // Mailboxes live in the ring.
+                options->ring = true;
+                options->mailboxes = true;
+                break;
+            case 'w':
+                if ((options->stallMillis = read_int(optarg)) < 0) {
+                    exit_game(ERROR_INCORRECT_ARGS);
+                }
+                break;
+            case 'S':
+                options->servePath = optarg;
+                break;
+            case 'o':
+                if (!find_format(optarg, &options->format)) {
+                    exit_game(ERROR_INCORRECT_ARGS);
+                }
+                break;
+            case 'e':
+                options->errorPath = optarg;
+                break;
+            case 'k':
+                // The tail is sized in bytes, which must fit an int.
+                if ((options->keepKib = read_int(optarg)) < 1 
+                        || options->keepKib > INT_MAX / KIB) {
+                    exit_game(ERROR_INCORRECT_ARGS);
+                }
+                break;
+            case 'p':
+                options->pool = true;
+                break;
+            case 'l':
+                options->logPath = optarg;
+                break;
+            case 'm':
+                options->metricsPath = optarg;
+                break;
+            case 'n':
+                if ((options->games = read_int(optarg)) < 1) {
+                    exit_game(ERROR_INCORRECT_ARGS);
+                }
+                break;
+            case 's':
+                errno = 0;
+                options->seed = strtoull(optarg, &end, 0);
+                if (errno || end == optarg || *end || *optarg == '-') {
+                    exit_game(ERROR_INCORRECT_ARGS);
+                }
+                break;
+            default:
+                exit_game(ERROR_INCORRECT_ARGS);
+        }
     }
-
-    // Output scores.
-    for (int i = 0; i < game->playerCount; i++) {
-        Player competitor = game->players[i];
-        competitor.score = (competitor.specialCards < game->threshold)
-                ? competitor.score - competitor.specialCards 
-                : competitor.score + competitor.specialCards;
-        // Control spacing of scores.
-        (i == 0) ? printf("%d:%d", i, competitor.score) : 
-                printf(" %d:%d", i, competitor.score);
-    }
-    printf("\n");
+    return optind;
 }
 
 /**
- * Inform player processes that a new round has begun.
- * 
- * @param game - Information about the game state.
- * @param leadPlayer - Player going first.
+ * Find the decks to play in a tournament.
+ *
+ * @param options - The command line options.
+ * @param path - The deck argument.
+ * @param decks - The decks to play.
+ * @return Whether the decks were valid.
  */ 
-void send_new_round(HubInfo* game, int leadPlayer) {
-    for (int i = 0; i < game->playerCount; i++) {
-        fprintf(game->players[i].write, "%s%d\n", 
-                RECIEVE_NEWROUND, leadPlayer);
-        fflush(game->players[i].write);
+bool load_decks(const HubOptions* options, const char* path, 
+        DeckSet* decks) {
+    if (options->games) {
+        return generate_decks(path, options->games, options->seed, decks);
     }
+    return read_deck_list(path, decks);
 }
 
 /**
- * Inform player processes of a played card.
- * 
+ * Play every deck listed in a file with the same player processes.
+ *
  * @param game - Information about the game state.
- * @param player - The player who played the card.
- * @param played - The card that was played.
+ * @param argv - A list of command line arguments.
+ * @param options - The command line options.
  */ 
-void send_played(HubInfo* game, int player, Card played) {
-    for (int i = 0; i < game->playerCount; i++) {
-        if (i == player) {
-            continue;
+void run_tournament(HubInfo* game, char** argv, const HubOptions* options) {
+    DeckSet decks;
+    if (!load_decks(options, argv[1], &decks)) {
+        exit_game(ERROR_DECK);
+    }
+    unsigned char* buffer = malloc(deck_buffer_size(&decks));
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (game->games = 0; game->games < decks.count; game->games++) {
+        Deck deck;
+        if (!deck_at(&decks, game->games, buffer, &deck)) {
+            end_players(game);
+            exit_game(ERROR_DECK);
         }
-        fprintf(game->players[i].write, "%s%d,%c%c\n", 
-                RECIEVE_PLAYED, player, played.suit, played.rank);
-        fflush(game->players[i].write);
+        game->deck = deck.cards;
+        game->deckSize = deck.size;
+
+        // Players are only started once and reset between games.
+        if (game->games == 0) {
+            init_players(game, argv);
+        } else {
+            check_game(game, new_game(game));
+        }
+        check_game(game, run_game(game));
     }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    output_totals(game, (end.tv_sec - start.tv_sec) 
+            + (end.tv_nsec - start.tv_nsec) / 1e9);
+    free(buffer);
+    free_decks(&decks);
 }
 
 /**
- * Output an array of cards to stdout
- * 
- * @param played the array to rpint
- * @param cardCount the array size
+ * Play every deck listed in a file on a pool of threads. All players must 
+ * be in-process strategies.
+ *
+ * @param game - Information about the game state.
+ * @param argv - A list of command line arguments.
+ * @param options - The command line options.
  */ 
-void output_cards(Card* played, int cardCount) {
-    printf("Cards=");
-    for (int i = 0; i < cardCount; i++) {
-        (i == 0) ? printf("%c.%c", played[i].suit, played[i].rank) : 
-                printf(" %c.%c", played[i].suit, played[i].rank);
+void run_parallel_games(HubInfo* game, char** argv, 
+        const HubOptions* options) {
+    DeckSet decks;
+    int jobs = options->jobs;
+    Strategy strategies[game->playerCount];
+
+    for (int i = 0; i < game->playerCount; i++) {
+        if (!find_strategy(argv[i + NON_PLAYER_ARGS], &strategies[i]) 
+                || !strategies[i].play) {
+            exit_game(ERROR_PLAYER);
+        }
+    }
+    if (!load_decks(options, argv[1], &decks)) {
+        exit_game(ERROR_DECK);
     }
-    printf("\n");
+    if (jobs == 0) {
+        jobs = sysconf(_SC_NPROCESSORS_ONLN);
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    int* scores = malloc(sizeof(int) * decks.count * game->playerCount);
+    int status = run_parallel(game, strategies, &decks, jobs, scores);
+    if (status != NORMAL_EXIT) {
+        exit_game(status);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    for (int i = 0; i < decks.count; i++) {
+        report_scores(game->report, i, scores + i * game->playerCount, 
+                game->playerCount);
+    }
+    output_totals(game, (end.tv_sec - start.tv_sec) 
+            + (end.tv_nsec - start.tv_nsec) / 1e9);
+    free(scores);
+    free_decks(&decks);
 }
 
 /**
- * Read the card a player has played.
- * 
+ * End the game if a game function failed.
+ *
  * @param game - Information about the game state.
- * @param line - A string of text.
- * @param currentPlayer - The player whose turn it was.
+ * @param status - The value returned by the game function.
  */ 
-Card parse_play(HubInfo* game, char* line, int currentPlayer) {
-    if (check_command(line, SEND_PLAY, false) 
-            || !check_card(line += strlen(SEND_PLAY))) {
+void check_game(HubInfo* game, int status) {
+    if (status != NORMAL_EXIT) {
+        dump_errors(game);
         end_players(game);
-        exit_game(ERROR_PLAYER_MESSAGE);
+        if (game->metrics) {
+            write_metrics(game);
+        }
+        exit_game(status);
     }
+}
 
-    Card toPlay = (Card) {.suit = line[0], .rank = line[1]};
-
-    // Remove the card from the players hand.
-    if (!rotate_hand(game->players[currentPlayer].hand, 
-            &game->players[currentPlayer].handSize, toPlay)) {
-        end_players(game);
-        exit_game(ERROR_CARD_CHOICE);
-    }
-    return toPlay;
+/**
+ * Start collecting player metrics, written to a file when the hub exits 
+ * and whenever it receives SIGUSR1.
+ *
+ * @param game - Information about the game state.
+ * @param metrics - Where to keep the metrics.
+ * @param path - The file to write the metrics to.
+ */ 
+void start_metrics(HubInfo* game, Metrics* metrics, const char* path) {
+    struct sigaction request = {.sa_handler = request_metrics};
+    init_metrics(metrics, path, game->playerCount);
+    game->metrics = metrics;
+    // Without SA_RESTART the signal interrupts poll, which writes the file.
+    sigaction(SIGUSR1, &request, NULL);
+    game->events->interrupted = check_metrics;
+    game->events->context = game;
 }
 
 /**
- * Run a round of the game
+ * Output the aggregate results of a tournament to stdout
  * 
  * @param game - Information about the game state.
- * @param leadPlayer - The player going first.
+ * @param seconds - The time taken to play every game.
  */ 
-int play_round(HubInfo* game, int leadPlayer) {
-    char* line;
-    int winner = leadPlayer;
-    int specials = 0;
-    int cardCount = 0;
-    Card lead;
-    Card played[game->playerCount];
-
-    send_new_round(game, leadPlayer);
-    printf("Lead player=%d\n", leadPlayer);
-    
-    // Main round loop
-    while (cardCount < game->playerCount) {
-        if (!read_line(game->players[leadPlayer].read, &line)) {
-            end_players(game);
-            exit_game(ERROR_PLAYER_EOF);
-        } 
-        played[cardCount] = parse_play(game, line, leadPlayer);
-        
-        // The first player is the lead.
-        if (cardCount == 0) {
-            lead = played[cardCount];
-        } else if (played[cardCount].suit == lead.suit 
-                && played[cardCount].rank > lead.rank) {
-            lead = played[cardCount];
-            winner = leadPlayer;
-        }
-
-        send_played(game, leadPlayer, played[cardCount]);
-        // Track all special cards played in a round.
-        specials += (played[cardCount++].suit == SPECIAL_SUIT);
-        leadPlayer = (leadPlayer + 1) % game->playerCount;
-        free(line);
+void output_totals(HubInfo* game, double seconds) {
+    long scores[game->playerCount];
+    long wins[game->playerCount];
+    for (int i = 0; i < game->playerCount; i++) {
+        scores[i] = game->players[i].totalScore;
+        wins[i] = game->players[i].wins;
     }
-    game->players[winner].specialCards += specials;
-    game->players[winner].score += 1;
-
-    output_cards(played, cardCount);
-
-    return winner;
+    report_totals(game->report, &(Totals) {.games = game->games, 
+            .seconds = seconds, .playerCount = game->playerCount, 
+            .scores = scores, .wins = wins, 
+            .messages = game->events ? game->events->messages : 0, 
+            .writes = game->events ? game->events->writes : 0});
 }
 
 /**
@@ -185,37 +384,31 @@ int play_round(HubInfo* game, int leadPlayer) {
  * @param game - Information about the game state.
  */ 
 void parse_deck(HubInfo* game, char* deck) {
-    FILE* deckFile;
-    deckFile = fopen(deck, "r");
-    if (!deckFile) {
+    Deck read;
+    if (!read_deck(deck, &read)) {
         exit_game(ERROR_DECK);
     }
+    game->deck = read.cards;
+    game->deckSize = read.size;
+}
 
-    char* line;
-    int lineN = 0;
-
-    if (!read_line(deckFile, &line) 
-            || (game->deckSize = read_int(line)) <= 0) {
-        exit_game(ERROR_DECK);
-    } 
-
-    free(line);
-
-    game->deck = malloc(sizeof(Card) * game->deckSize);
-
-    while (read_line(deckFile, &line)) {
-        // check cards are within array size.
-        if (lineN >= game->deckSize || !check_card(line)) {
-            exit_game(ERROR_DECK);
+/**
+ * Show the last of what each player process wrote to stderr, once the 
+ * game has gone wrong.
+ * 
+ * @param game - Information about the game state.
+ */ 
+void dump_errors(HubInfo* game) {
+    for (int i = 0; i < game->playerCount && game->captureSize; i++) {
+        Player* player = &game->players[i];
+        if (player->local || !player->error.loop) {
+            continue;
         }
-        game->deck[lineN++] = (Card) {.suit = line[0], .rank = line[1]};
-        free(line);
-    }
-
-    fclose(deckFile);
-    // check deck is not under sized.
-    if (lineN != game->deckSize) {
-        exit_game(ERROR_DECK);
+        // Whatever a player wrote as it ended may not have been drained.
+        if (!player->error.closed) {
+            fill_channel(&player->error);
+        }
+        dump_capture(&player->capture, i);
     }
 }
 
@@ -225,14 +418,8 @@ void parse_deck(HubInfo* game, char* deck) {
  * @param sig - The signal recieved.
  */
 void handle_death(int sig) {
-    // Ignore SIGPIPE.
-    int i = 0;
+    // Ignore SIGPIPE. Players are killed by the kernel when the hub exits.
     if (sig != SIGPIPE) {
-        if (processes != NULL) {
-            while (processes[i] != -1) {
-                kill(processes[i++], SIGKILL);
-            }
-        }
         exit_game(ERROR_SIGHUP);   
     } 
 }
@@ -244,16 +431,35 @@ void handle_death(int sig) {
  * @param argv - A list of command line arguments.
  */ 
 void init_players(HubInfo* game, char** argv) {
-    game->players = malloc(sizeof(Player) * game->playerCount);
+    game->players = calloc(game->playerCount, sizeof(Player));
     
     // Set up to handle SIGHUP and suppress SIGPIPE from players.
     struct sigaction sa = {.sa_handler = handle_death};
     sigaction(SIGHUP, &sa, NULL);
     sigaction(SIGPIPE, &sa, NULL);
 
-    deal_cards(game);
+    int status = deal_cards(game);
+    if (status != NORMAL_EXIT) {
+        exit_game(status);
+    }
+
+    offer_protocol(game);
+    raise_file_limit();
+
+    // Every player is started before any is waited on, so they all start 
+    // up at once.
     for (int i = 0; i < game->playerCount; i++) {
         char* args[EXPECTED_ARGS + 2];
+        Strategy strategy;
+
+        if (find_strategy(argv[i + 3], &strategy)) {
+            if (!strategy.play) {
+                exit_game(ERROR_PLAYER);
+            }
+            create_local(game, i, strategy);
+            send_hand(game, i);
+            continue;
+        }
 
         // Create the array of arguments to pass each player.
         args[0] = argv[i + 3];
@@ -263,120 +469,248 @@ void init_players(HubInfo* game, char** argv) {
         string_of(game->players[i].handSize, &args[4]);
         args[5] = NULL;
 
-        if (!create_player(&game->players[i], args) 
-                || !send_cards(&game->players[i])) {
+        if (!create_player(game, i, args)) {
+            exit_game(ERROR_PLAYER);
+        }
+        send_hand(game, i);
+    }
+    if (game->pool) {
+        empty_pool(game->pool);
+        game->pool = NULL;
+    }
+    for (int i = 0; i < game->playerCount; i++) {
+        if (!await_player(game, i)) {
+            dump_errors(game);
             exit_game(ERROR_PLAYER);
         }
-
-        // Populate global variables.
-        processes[i] = game->players[i].track;
     }
 }
 
 /**
- * Send players their hands
+ * Only offer the binary protocol, the ring or mailboxes when asked to. 
+ * Players inherit this.
  * 
- * @param player - An array of players.
+ * @param game - Information about the game state.
  */ 
-bool send_cards(Player* player) {
-    fprintf(player->write, "HAND%d", player->handSize);
-    for (int j = 0; j < player->handSize; j++) {
-        fprintf(player->write, ",%c%c", 
-                player->hand[j].suit, player->hand[j].rank);
-    }
-    fprintf(player->write, "\n");
-    fflush(player->write);
-    // Check that the player is legitimate.
-    return fgetc(player->read) == PLAYER_READY;
+void offer_protocol(HubInfo* game) {
+    if (game->ring) {
+        char* fd;
+        setenv(PROTOCOL_VARIABLE, 
+                game->mailboxes ? PROTOCOL_MAILBOX : PROTOCOL_RING, true);
+        setenv(RING_VARIABLE, string_of(game->ring->fd, &fd), true);
+        free(fd);
+    } else if (game->binary) {
+        setenv(PROTOCOL_VARIABLE, PROTOCOL_BINARY, true);
+    } else {
+        unsetenv(PROTOCOL_VARIABLE);
+    }
 }
 
 /**
- * Kill all player processes.
- * 
- * @param game - Information about the game state.
+ * Allow the hub as many open files as it is permitted, since each player 
+ * process keeps three pipes open in it.
  */ 
-void end_players(HubInfo* game) {
-    for (int i = 0; i < game->playerCount; i++) {
-        // fflush occurs when the hub exits (inevitable if we're here).
-        fprintf(game->players[i++].write, "%s\n", RECIEVE_GAMEOVER);
+void raise_file_limit(void) {
+    struct rlimit limit;
+    if (!getrlimit(RLIMIT_NOFILE, &limit) && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
     }
 }
 
 /**
- * Assign some cards to each player
+ * Wait for a started player to accept its hand.
  * 
  * @param game - Information about the game state.
+ * @param playerNum - The player to wait for.
+ * @return Whether the player is legitimate.
  */ 
-void deal_cards(HubInfo* game) {
-    // The number of cards for each player to recieve. Also the # of rounds.
-    game->round = game->deckSize / game->playerCount;
-    
-    // Check that there are enough cards for each player.
-    if (game->round == 0) {
-        exit_game(ERROR_CARD_COUNT);
+bool await_player(HubInfo* game, int playerNum) {
+    Player* player = &game->players[playerNum];
+    if (player->local) {
+        return true;
     }
-
-    int offset;
-    for (int i = 0; i < game->playerCount; i++) {
-        game->players[i].hand = malloc(sizeof(Card) * game->round);
-        game->players[i].handSize = game->round;
-
-        // Assign cards from deck based on player number.
-        offset = game->round * i;
-        for (int j = offset; j < offset + game->round; j++) {
-            game->players[i].hand[j - offset] = 
-                    (Card) {.suit = game->deck[j].suit, 
-                    .rank = game->deck[j].rank};
-        }
+    // Check that the player is legitimate and if it accepted binary.
+    int ready = wait_for_char(&player->read);
+    if (game->mailboxes && ready == PLAYER_READY_MAILBOX) {
+        player->mailbox = mailbox_of(game->ring, playerNum);
+        // Players answer in their mailbox from now on.
+        player->replies = 0;
     }
+    player->shared = game->ring && (ready == PLAYER_READY_RING 
+            || player->mailbox);
+    player->binary = player->shared 
+            || (game->binary && ready == PLAYER_READY_BINARY);
+    game->piped += !player->shared;
+    return ready == PLAYER_READY || player->binary;
 }
 
 /**
- * Initialise a player process
+ * Create a pipe whose ends are closed when either process calls exec.
  * 
- * @param newProcess - The name of the process to create.
+ * @param ends - Set to the read and write ends.
+ * @return Whether the pipe was created.
+ */ 
+bool open_pipe(int ends[2]) {
+    // The ends are close-on-exec from the moment they exist, rather than 
+    // after a call of fcntl for each.
+    return !pipe2(ends, O_CLOEXEC);
+}
+
+/**
+ * Initialise a player process, taking it from the pool if one was started 
+ * there.
+ * 
+ * @param game - Information about the game state.
+ * @param playerNum - The seat of the player.
  * @param args - The command line arguments to pass.
+ * @return Whether the player program was started.
  */ 
-bool create_player(Player* newProcess, char** args) {
+bool create_player(HubInfo* game, int playerNum, char** args) {
+    Player* newProcess = &game->players[playerNum];
     // Initialise scores
     newProcess->score = 0;
     newProcess->specialCards = 0;
+    newProcess->totalScore = 0;
+    newProcess->squaredScore = 0;
+    newProcess->wins = 0;
+    newProcess->local = NULL;
+    newProcess->binary = false;
+    newProcess->shared = false;
+    newProcess->mailbox = NULL;
+
+    Process process;
+    Spare* spare = game->pool ? take_spare(game->pool, args[0]) : NULL;
+    bool started = spare ? spare->started 
+            : start_process(args, &process);
+    if (spare) {
+        process = spare->process;
+    }
+    newProcess->track = process.track;
+    if (process.read == -1) {
+        return false;
+    }
 
+    // Every pipe is watched so that no player can block on a full one.
+    open_channel(&newProcess->read, game->events, process.read, 
+            CHANNEL_READ, playerNum);
+    open_channel(&newProcess->write, game->events, process.write, 
+            CHANNEL_WRITE, playerNum);
+    open_channel(&newProcess->error, game->events, process.error, 
+            CHANNEL_ERROR, playerNum);
+    if (game->capturePath || game->captureSize) {
+        started = open_capture(&newProcess->capture, game->capturePath, 
+                playerNum, game->captureSize) && started;
+        newProcess->error.capture = &newProcess->capture;
+    }
+
+    // A spare was started without arguments. It says it is waiting, 
+    // usually long before it is taken, and is then told its seat.
+    if (spare && started) {
+        started = wait_for_char(&newProcess->read) == PLAYER_WAITING;
+        send_seat(game, playerNum);
+    }
+    return started;
+}
+
+/**
+ * Start a player program with its stdin, stdout and stderr piped to the 
+ * hub.
+ * 
+ * @param args - The command line arguments to pass.
+ * @param process - Set to the process, with -1 for any pipe that was not 
+ *      opened.
+ * @return Whether the program was executed.
+ */ 
+bool start_process(char** args, Process* process) {
     int send[2];
     int recieve[2];
     int error[2];
-    
-    pipe(send);
-    pipe(recieve);
-    pipe(error);
+    int status[2];
+    *process = (Process) {.track = -1, .read = -1, .write = -1,
+            .error = -1};
+
+    // The search is done before forking, since the child may only make 
+    // calls that are safe in a signal handler.
+    char* program = find_program(args[0]);
+    if (!program) {
+        return false;
+    }
+    if (!open_pipe(send) || !open_pipe(recieve) || !open_pipe(error) 
+            || !open_pipe(status)) {
+        free(program);
+        return false;
+    }
      
-    if (!(newProcess->track = fork())) {
-        // Child process
-        close(send[READ_END]);
-        close(recieve[WRITE_END]);
-        close(error[READ_END]);
-
-        dup2(send[WRITE_END], STDOUT_FILENO);
-        dup2(recieve[READ_END], STDIN_FILENO);
-        dup2(error[WRITE_END], STDERR_FILENO);
-            
-        execvp(args[0], args);
+    // The child shares our memory until it execs, so it only makes calls 
+    // that touch its own file descriptors.
+    pid_t hub = getpid();
+    if (!(process->track = vfork())) {
+        // Child process, killed if the hub dies.
+        prctl(PR_SET_PDEATHSIG, SIGKILL);
+        if (getppid() == hub 
+                && dup2(send[WRITE_END], STDOUT_FILENO) != -1 
+                && dup2(recieve[READ_END], STDIN_FILENO) != -1 
+                && dup2(error[WRITE_END], STDERR_FILENO) != -1) {
+            execv(program, args);
+        }
         
-        // Inform the hub that the process failed.
-        fprintf(stdin, "%c", FAIL);
-
-        // Exit closes all files.
-        exit(ERROR_PLAYER);
+        // Inform the hub that the process failed, without touching the 
+        // stack frame the hub resumes in.
+        write(status[WRITE_END], &errno, sizeof(errno));
+        _exit(ERROR_PLAYER);
     }
+    free(program);
     // Close unwanted fd's.
     close(error[WRITE_END]);
     close(send[WRITE_END]);
     close(recieve[READ_END]);
+    close(status[WRITE_END]);
+    process->read = send[READ_END];
+    process->write = recieve[WRITE_END];
+    process->error = error[READ_END];
+
+    // The status pipe closes empty on a successful exec.
+    int failure;
+    bool started = process->track != -1 
+            && read(status[READ_END], &failure, sizeof(failure)) == 0;
+    close(status[READ_END]);
+    return started;
+}
 
-    newProcess->read = fdopen(send[READ_END], "r");
-    newProcess->write = fdopen(recieve[WRITE_END], "w");
-
-    return newProcess->read && newProcess->write;
+/**
+ * Find a player program the way execvp would, by searching PATH for names 
+ * without a slash.
+ * 
+ * @param name - The program named on the command line.
+ * @return The path to execute, which the caller frees, or NULL if no 
+ *      executable file was found.
+ */ 
+char* find_program(const char* name) {
+    if (strchr(name, '/')) {
+        return strdup(name);
+    }
+    const char* path = getenv("PATH") ? getenv("PATH") : DEFAULT_PATH;
+    char* candidate = malloc(strlen(path) + strlen(name) + 2);
+    while (true) {
+        int length = strcspn(path, ":");
+        // An empty entry is the current directory.
+        memcpy(candidate, path, length);
+        candidate[length] = '/';
+        strcpy(candidate + (length ? length + 1 : 0), name);
+
+        struct stat info;
+        if (!stat(candidate, &info) && S_ISREG(info.st_mode) 
+                && !access(candidate, X_OK)) {
+            return candidate;
+        }
+        if (!path[length]) {
+            break;
+        }
+        path += length + 1;
+    }
+    free(candidate);
+    return NULL;
 }
 
 /* Exits the game with specifid error Code
@@ -384,6 +718,17 @@ bool create_player(Player* newProcess, char** args) {
  * @param exitCode - what to exit with
  */
 void exit_game(int exitCondition) {
+    fputs(error_message(exitCondition), stderr);
+    exit(exitCondition);
+}
+
+/**
+ * Find the message describing an exit condition.
+ * 
+ * @param exitCondition - The condition to describe.
+ * @return The message, ending in a newline unless it is empty.
+ */ 
+const char* error_message(int exitCondition) {
     const char* messages[] = {"",
             "Usage: 2310hub deck threshold player0 {player1}\n",
             "Invalid threshold\n",
@@ -394,6 +739,5 @@ void exit_game(int exitCondition) {
             "Invalid message\n",
             "Invalid card choice\n",
             "Ended due to signal\n"};
-    fputs(messages[exitCondition], stderr);
-    exit(exitCondition);
-}
+    return messages[exitCondition];
+}
\ No newline at end of file
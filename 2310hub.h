@@ -1,85 +1,109 @@
 #ifndef _2310HUB_H_
 #define _2310HUB_H_
 
+// pipe2 is only declared with _GNU_SOURCE.
+#define _GNU_SOURCE
 #include <unistd.h>
+#include <fcntl.h>
 #include <signal.h>
 #include <sys/wait.h>
+#include <sys/prctl.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
 #include <sys/types.h> 
-#include "utilities.h"
-
-#define ERROR_INCORRECT_ARGS 1
-#define ERROR_INVALID_THRESHOLD 2 
-#define ERROR_DECK 3
-#define ERROR_CARD_COUNT 4
-#define ERROR_PLAYER 5
-#define ERROR_PLAYER_EOF 6
-#define ERROR_PLAYER_MESSAGE 7
-#define ERROR_CARD_CHOICE 8
-#define ERROR_SIGHUP 9
+#include <getopt.h>
+#include <time.h>
+#include "game.h"
 
 #define EXPECTED_HUB_ARGS 4
 #define NON_PLAYER_ARGS 3
-#define FAIL '%'
+#define KIB 1024
+#define DEFAULT_PATH "/bin:/usr/bin"
+
+#define HUB_OPTIONS "+tj:w:bn:s:m:l:rfS:o:e:k:p"
 
 /**
- * Representation of a player.
- * 
- * @param hand - An array of cards
- * @param handSize - The number of cards
- * @param score - rounds won by the player
- * @param specialCards - D cards won by the player
- * @param track - The players process ID
- * @param read - A file to read the players messages
- * @param write - A file to write the player messages
+ * Command line options given before the positional arguments.
+ *
+ * @param tournament - The deck argument lists one deck file per line
+ * @param jobs - Threads to play a tournament on, -1 to use processes
+ * @param stallMillis - Report players slower than this, or NO_STALL
+ * @param binary - Offer players the binary protocol
+ * @param games - Decks to shuffle from the deck argument as a spec, or 0 
+ *      to read decks from files
+ * @param seed - The seed shuffled decks come from
+ * @param metricsPath - Where to write player metrics, or NULL
+ * @param logPath - The game log to append to, or NULL
+ * @param ring - Offer players a shared ring to read broadcasts from
+ * @param mailboxes - Also offer players mailboxes in the ring to take 
+ *      turns through
+ * @param servePath - The socket to seat connecting players from, or NULL 
+ *      to start player processes
+ * @param format - How results are printed, one of the REPORT formats
+ * @param errorPath - Where to append the stderr of player processes, 
+ *      or NULL
+ * @param keepKib - The KiB of each players stderr to show if the game 
+ *      ends in an error, or 0
+ * @param pool - Start every player process before the game is set up and 
+ *      seat it once it is
  */ 
 typedef struct {
-    Card* hand;
-    int handSize;
-    int score;
-    int specialCards;
-    pid_t track;
-    FILE* read;
-    FILE* write;
-} Player;
+    bool tournament;
+    int jobs;
+    int stallMillis;
+    bool binary;
+    int games;
+    uint64_t seed;
+    const char* metricsPath;
+    const char* logPath;
+    bool ring;
+    bool mailboxes;
+    const char* servePath;
+    int format;
+    const char* errorPath;
+    int keepKib;
+    bool pool;
+} HubOptions;
 
 /**
- * Stores all information pertaining to the game
- *
- * @param threshold - The number of D cards needed for an additional score
- * @param playerCount - The number of players
- * @param deckSize - The number of cards stored in the hub.
- * @param round - The number of rounds to play
- * @param deck - All cards in the game
- * @param players - All the players in the game
+ * A player process and the hubs ends of its pipes.
+ * 
+ * @param track - The process ID, or -1 if it could not be started
+ * @param read - Reads what the process writes to stdout, or -1
+ * @param write - Writes to the stdin of the process, or -1
+ * @param error - Reads what the process writes to stderr, or -1
  */ 
 typedef struct {
-    int threshold;
-    int playerCount;
-    int deckSize;
-    int round;
-    Card* deck;
-    Player* players;
-} HubInfo;
+    pid_t track;
+    int read;
+    int write;
+    int error;
+} Process;
 
 /* Game Running functions */
 void exit_game(int exitCondition);
+const char* error_message(int exitCondition);
 void init_players(HubInfo* game, char** argv);
-void run_game(HubInfo* game);
 void handle_death(int sig);
-void end_players(HubInfo* game);
+int parse_options(HubOptions* options, int argc, char** argv);
+void run_tournament(HubInfo* game, char** argv, const HubOptions* options);
+void run_parallel_games(HubInfo* game, char** argv, 
+        const HubOptions* options);
+bool load_decks(const HubOptions* options, const char* path, 
+        DeckSet* decks);
+void check_game(HubInfo* game, int status);
+void start_metrics(HubInfo* game, Metrics* metrics, const char* path);
+void offer_protocol(HubInfo* game);
+void raise_file_limit(void);
+void dump_errors(HubInfo* game);
 
 /* File IO functions */
 void parse_deck(HubInfo* game, char* deck);
-bool send_cards(Player* player);
-void message_players(Player** players, char* message);
-void send_played(HubInfo* game, int player, Card played);
-void send_new_round(HubInfo* game, int leadPlayer);  
-void output_cards(Card* played, int cardCount);
-bool create_player(Player* newProcess, char** args);
-
-/* Helper functions */
-int play_round(HubInfo* game, int leadPlayer);
-Card parse_play(HubInfo* game, char* line, int currentPlayer);
-void deal_cards(HubInfo* game);
+void output_totals(HubInfo* game, double seconds);
+bool create_player(HubInfo* game, int playerNum, char** args);
+bool start_process(char** args, Process* process);
+bool open_pipe(int ends[2]);
+char* find_program(const char* name);
+bool await_player(HubInfo* game, int playerNum);
 
 #endif //_2310HUB_H_
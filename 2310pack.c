@@ -0,0 +1,33 @@
+#include "2310pack.h"
+
+/**
+ * Convert the decks named in a deck list into a single pack file.
+ */ 
+int main(int argc, char** argv) {
+    if (argc != PACK_ARGS) {
+        exit_pack(ERROR_PACK_ARGS);
+    }
+
+    // Every card is checked here so the hub doesn't have to.
+    DeckSet decks;
+    if (!read_deck_list(argv[1], &decks)) {
+        exit_pack(ERROR_PACK_DECK);
+    }
+    bool written = write_pack(argv[2], &decks);
+    free_decks(&decks);
+
+    exit_pack(written ? NORMAL_EXIT : ERROR_PACK_WRITE);
+}
+
+/* Exits the packer with specifid error Code
+ *
+ * @param exitCode - what to exit with
+ */
+int exit_pack(int exitCondition) {
+    const char* messages[] = {"",
+            "Usage: 2310pack decklist pack\n",
+            "Deck error\n",
+            "Write error\n"};
+    fputs(messages[exitCondition], stderr);
+    exit(exitCondition);
+}
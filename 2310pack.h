@@ -0,0 +1,14 @@
+#ifndef _2310PACK_H_
+#define _2310PACK_H_
+
+#include "deck.h"
+
+#define PACK_ARGS 3
+
+#define ERROR_PACK_ARGS 1
+#define ERROR_PACK_DECK 2
+#define ERROR_PACK_WRITE 3
+
+int exit_pack(int exitCondition);
+
+#endif // _2310PACK_H_
@@ -0,0 +1,238 @@
+#include "2310replay.h"
+
+/**
+ * Work out the scores of every game in a log without running any players.
+ */ 
+int main(int argc, char** argv) {
+    bool quiet = false;
+    int option;
+    opterr = 0;
+    while ((option = getopt(argc, argv, REPLAY_OPTIONS)) != -1) {
+        if (option != 'q') {
+            exit_replay(ERROR_REPLAY_ARGS);
+        }
+        quiet = true;
+    }
+    if (argc - optind != REPLAY_ARGS - 1) {
+        exit_replay(ERROR_REPLAY_ARGS);
+    }
+
+    int fd = open(argv[optind], O_RDONLY);
+    struct stat info;
+    if (fd == -1 || fstat(fd, &info) == -1 || info.st_size < LOG_MAGIC_SIZE) {
+        exit_replay(ERROR_REPLAY_LOG);
+    }
+    unsigned char* data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, 
+            fd, 0);
+    close(fd);
+    if (data == MAP_FAILED || memcmp(data, LOG_MAGIC, LOG_MAGIC_SIZE)) {
+        exit_replay(ERROR_REPLAY_LOG);
+    }
+
+    bool replayed = replay_log(data + LOG_MAGIC_SIZE, 
+            info.st_size - LOG_MAGIC_SIZE, quiet);
+    munmap(data, info.st_size);
+    exit_replay(replayed ? NORMAL_EXIT : ERROR_REPLAY_LOG);
+}
+
+/**
+ * Replay every record of a log, reporting totals for each seating.
+ *
+ * @param data - The records of the log.
+ * @param length - The size of the records.
+ * @param quiet - Whether to only report totals.
+ * @return Whether every record was valid.
+ */ 
+bool replay_log(const unsigned char* data, long length, bool quiet) {
+    Seating seating = {.playerCount = 0, .totals = NULL, .wins = NULL};
+    LogRecord record;
+    long used;
+    int* scores = NULL;
+    int* winners = NULL;
+    int capacity = 0;
+    bool valid = true;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    while (length > 0) {
+        if (!(used = read_record(data, length, &record))) {
+            valid = false;
+            break;
+        }
+        data += used;
+        length -= used;
+
+        if (record.type == LOG_SEATING) {
+            clock_gettime(CLOCK_MONOTONIC, &end);
+            end_seating(&seating, (end.tv_sec - start.tv_sec) 
+                    + (end.tv_nsec - start.tv_nsec) / 1e9);
+            start_seating(&seating, &record, quiet);
+            scores = realloc(scores, sizeof(int) * record.playerCount);
+            start = end;
+            continue;
+        }
+        if (record.count > capacity) {
+            capacity = record.count;
+            winners = realloc(winners, sizeof(int) * capacity);
+        }
+        // A game must follow the seating it was played by.
+        if (!replay_game(&seating, &record, scores, winners)) {
+            valid = false;
+            break;
+        }
+        if (!quiet) {
+            printf("Deck=%d ", record.deck);
+            output_winners(winners, record.count / seating.playerCount);
+            output_scores(scores, seating.playerCount);
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    end_seating(&seating, (end.tv_sec - start.tv_sec) 
+            + (end.tv_nsec - start.tv_nsec) / 1e9);
+    free(scores);
+    free(winners);
+    return valid;
+}
+
+/**
+ * Start totalling the games of a new seating.
+ *
+ * @param seating - The totals to reset.
+ * @param record - The seating record.
+ * @param quiet - Whether to skip printing the players.
+ */ 
+void start_seating(Seating* seating, const LogRecord* record, bool quiet) {
+    seating->threshold = record->threshold;
+    seating->playerCount = record->playerCount;
+    seating->games = 0;
+    seating->totals = calloc(record->playerCount, sizeof(long));
+    seating->wins = calloc(record->playerCount, sizeof(int));
+
+    if (!quiet) {
+        const unsigned char* names = record->names;
+        printf("Players=");
+        for (int i = 0; i < record->playerCount; i++) {
+            const char* name;
+            int length;
+            names += read_name(names, &name, &length);
+            printf((i == 0) ? "%.*s" : " %.*s", length, name);
+        }
+        printf("\n");
+    }
+}
+
+/**
+ * Report the totals of a seating and free them.
+ *
+ * @param seating - The seating to report, if it played any games.
+ * @param seconds - The time taken to replay it.
+ */ 
+void end_seating(Seating* seating, double seconds) {
+    if (!seating->totals) {
+        return;
+    }
+    printf("Games=%d Time=%.3f Rate=%.1f\n", seating->games, seconds, 
+            (seconds > 0) ? seating->games / seconds : 0);
+    printf("Totals=");
+    for (int i = 0; i < seating->playerCount; i++) {
+        (i == 0) ? printf("%d:%ld", i, seating->totals[i]) : 
+                printf(" %d:%ld", i, seating->totals[i]);
+    }
+    printf("\nWins=");
+    for (int i = 0; i < seating->playerCount; i++) {
+        (i == 0) ? printf("%d:%d", i, seating->wins[i]) : 
+                printf(" %d:%d", i, seating->wins[i]);
+    }
+    printf("\n");
+    free(seating->totals);
+    free(seating->wins);
+    seating->totals = NULL;
+    seating->wins = NULL;
+}
+
+/**
+ * Play the cards of a logged game back, as play_round and run_game would.
+ *
+ * @param seating - The seating the game was played by.
+ * @param record - The game record.
+ * @param scores - Set to the final score of each player.
+ * @param winners - Set to the winner of each round.
+ * @return Whether the game could have been played by the seating.
+ */ 
+bool replay_game(Seating* seating, const LogRecord* record, int* scores, 
+        int* winners) {
+    int playerCount = seating->playerCount;
+    if (!seating->totals || playerCount < 1 || record->count % playerCount) {
+        return false;
+    }
+    int rounds = record->count / playerCount;
+    int specialCards[playerCount];
+    int lead = 0;
+    int best = 0;
+    int special = suit_index(SPECIAL_SUIT);
+    memset(scores, 0, sizeof(int) * playerCount);
+    memset(specialCards, 0, sizeof(specialCards));
+
+    const unsigned char* plays = record->plays;
+    for (int round = 0; round < rounds; round++) {
+        // Cards are compared as encode_card packs them, suit then rank.
+        int winner = lead;
+        unsigned char top = plays[0];
+        int specials = 0;
+        for (int i = 0; i < playerCount; i++) {
+            unsigned char card = plays[i];
+            if ((card & 0xf) == 0 || card >> 4 >= SUIT_COUNT) {
+                return false;
+            } else if (card >> 4 == top >> 4 && card > top) {
+                top = card;
+                winner = (lead + i) % playerCount;
+            }
+            specials += (card >> 4 == special);
+        }
+        plays += playerCount;
+        scores[winner]++;
+        specialCards[winner] += specials;
+        winners[round] = winner;
+        lead = winner;
+    }
+
+    for (int i = 0; i < playerCount; i++) {
+        scores[i] = final_score(scores[i], specialCards[i], 
+                seating->threshold);
+        seating->totals[i] += scores[i];
+        best = (scores[i] > scores[best]) ? i : best;
+    }
+    // Ties share the win.
+    for (int i = 0; i < playerCount; i++) {
+        seating->wins[i] += (scores[i] == scores[best]);
+    }
+    seating->games++;
+    return true;
+}
+
+/**
+ * Output the winner of each round of a game to stdout
+ *
+ * @param winners - The winner of each round.
+ * @param rounds - The number of rounds.
+ */ 
+void output_winners(int* winners, int rounds) {
+    printf("Winners=");
+    for (int i = 0; i < rounds; i++) {
+        (i == 0) ? printf("%d", winners[i]) : printf(" %d", winners[i]);
+    }
+    printf("\n");
+}
+
+/* Exits the replayer with specifid error Code
+ *
+ * @param exitCode - what to exit with
+ */
+void exit_replay(int exitCondition) {
+    const char* messages[] = {"",
+            "Usage: 2310replay [-q] log\n",
+            "Log error\n"};
+    fputs(messages[exitCondition], stderr);
+    exit(exitCondition);
+}
@@ -0,0 +1,40 @@
+#ifndef _2310REPLAY_H_
+#define _2310REPLAY_H_
+
+#include <sys/mman.h>
+#include <getopt.h>
+#include <time.h>
+#include "game.h"
+
+#define REPLAY_OPTIONS "+q"
+#define REPLAY_ARGS 2
+
+#define ERROR_REPLAY_ARGS 1
+#define ERROR_REPLAY_LOG 2
+
+/**
+ * Totals over the games of one seating.
+ *
+ * @param threshold - The number of D cards needed for an additional score
+ * @param playerCount - The number of players
+ * @param games - The number of games replayed
+ * @param totals - Final scores summed over every game
+ * @param wins - Games in which each player had the top score
+ */ 
+typedef struct {
+    int threshold;
+    int playerCount;
+    int games;
+    long* totals;
+    int* wins;
+} Seating;
+
+bool replay_log(const unsigned char* data, long length, bool quiet);
+void start_seating(Seating* seating, const LogRecord* record, bool quiet);
+void end_seating(Seating* seating, double seconds);
+bool replay_game(Seating* seating, const LogRecord* record, int* scores, 
+        int* winners);
+void output_winners(int* winners, int rounds);
+void exit_replay(int exitCondition);
+
+#endif // _2310REPLAY_H_
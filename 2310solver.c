@@ -0,0 +1,575 @@
+#include "2310solver.h"
+
+/**
+ * Find the best score each seat can guarantee on a deal and compare it to 
+ * what in-process strategies score on it.
+ */ 
+int main(int argc, char** argv) {
+    bool list = false;
+    int budget = SOLVER_BUDGET;
+    int option;
+    opterr = 0;
+    while ((option = getopt(argc, argv, SOLVER_OPTIONS)) != -1) {
+        if (option == 't') {
+            list = true;
+        } else if (option != 'b' || (budget = read_int(optarg)) < 0) {
+            exit_solver(ERROR_INCORRECT_ARGS);
+        }
+    }
+
+    // Shift the arguments so the deck is always argv[1].
+    argc -= optind - 1;
+    argv += optind - 1;
+    if (argc <= SOLVER_ARGS + 1) {
+        exit_solver(ERROR_INCORRECT_ARGS);
+    }
+
+    HubInfo game = {.playerCount = argc - SOLVER_ARGS, .report = NULL};
+    if ((game.threshold = read_int(argv[2])) < 2) {
+        exit_solver(ERROR_INVALID_THRESHOLD);
+    }
+    Strategy strategies[game.playerCount];
+    for (int i = 0; i < game.playerCount; i++) {
+        if (!find_strategy(argv[i + 3], &strategies[i]) 
+                || !strategies[i].play) {
+            exit_solver(ERROR_PLAYER);
+        }
+    }
+    DeckSet decks;
+    if (!load_solver_decks(list, argv[1], &decks)) {
+        exit_solver(ERROR_DECK);
+    }
+
+    // The strategies play every deal first, which also checks the decks.
+    int* played = malloc(sizeof(int) * decks.count * game.playerCount);
+    int status = run_parallel(&game, strategies, &decks, 1, played);
+    if (status != NORMAL_EXIT) {
+        exit_solver(status);
+    }
+
+    Solver solver;
+    init_solver(&solver, game.playerCount, game.threshold);
+    unsigned char* buffer = malloc(deck_buffer_size(&decks));
+    int lower[game.playerCount];
+    int upper[game.playerCount];
+    int gaps[game.playerCount];
+    int unsolved = 0;
+    memset(gaps, 0, sizeof(gaps));
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < decks.count; i++) {
+        Deck deck;
+        if (!deck_at(&decks, i, buffer, &deck) 
+                || !deal_solver(&solver, &deck)) {
+            exit_solver(ERROR_DECK);
+        }
+        // Each seat may use its share of the budget for the deal, and what 
+        // earlier seats left over.
+        int* scores = played + i * (long) game.playerCount;
+        long budgetStart = solver.nodes;
+        for (int seat = 0; seat < game.playerCount; seat++) {
+            solver.limit = (budget == NO_BUDGET) ? LONG_MAX : budgetStart 
+                    + (long) budget * (seat + 1) / game.playerCount;
+            if (solve_seat(&solver, seat, &lower[seat], &upper[seat])) {
+                gaps[seat] += lower[seat] - scores[seat];
+            } else {
+                unsolved++;
+            }
+        }
+        output_bounds(lower, upper, game.playerCount);
+        output_seats("Played", scores, game.playerCount);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double seconds = (end.tv_sec - start.tv_sec) 
+            + (end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("Games=%d Time=%.3f Rate=%.1f Nodes=%ld Unsolved=%d\n", 
+            decks.count, seconds, (seconds > 0) ? decks.count / seconds : 0, 
+            solver.nodes, unsolved);
+    output_seats("Gap", gaps, game.playerCount);
+
+    free(buffer);
+    free(played);
+    free(game.players);
+    free_solver(&solver);
+    free_decks(&decks);
+    exit_solver(NORMAL_EXIT);
+}
+
+/**
+ * Read the decks to solve.
+ *
+ * @param list - Whether the path lists decks or is a pack, rather than 
+ *      being a single deck.
+ * @param path - The file to read.
+ * @param decks - Set to the decks read.
+ * @return Whether the decks could be read.
+ */ 
+bool load_solver_decks(bool list, const char* path, DeckSet* decks) {
+    if (list) {
+        return read_deck_list(path, decks);
+    }
+    *decks = (DeckSet) {.decks = malloc(sizeof(Deck)), .count = 1, 
+            .map = NULL, .pattern = {.cards = NULL}};
+    if (!read_deck(path, &decks->decks[0])) {
+        free(decks->decks);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Set up a solver for games between some number of players.
+ *
+ * @param solver - The solver to set up.
+ * @param playerCount - The number of players.
+ * @param threshold - The number of D cards needed for an additional score.
+ */ 
+void init_solver(Solver* solver, int playerCount, int threshold) {
+    Random random = {.state = SOLVER_SEED};
+    *solver = (Solver) {.playerCount = playerCount, .threshold = threshold, 
+            .specialSuit = suit_index(SPECIAL_SUIT), 
+            .holding = malloc(sizeof(uint64_t) * playerCount), 
+            .counts = malloc(CARD_COUNT * playerCount), 
+            .ownerKeys = malloc(sizeof(uint64_t) * playerCount), 
+            .leadKeys = malloc(sizeof(uint64_t) * playerCount), 
+            .specialKeys = malloc(sizeof(uint64_t) * (threshold + 1)), 
+            .seatKeys = malloc(sizeof(uint64_t) * playerCount), 
+            .table = calloc(TABLE_SIZE, sizeof(TableEntry)), 
+            .generation = 0, .nodes = 0, .limit = LONG_MAX, 
+            .exhausted = false};
+
+    for (int i = 0; i < playerCount; i++) {
+        solver->ownerKeys[i] = next_random(&random);
+        solver->leadKeys[i] = next_random(&random);
+        solver->seatKeys[i] = next_random(&random);
+    }
+    for (int i = 0; i <= threshold; i++) {
+        solver->specialKeys[i] = next_random(&random);
+    }
+}
+
+/**
+ * Free everything a solver allocated.
+ *
+ * @param solver - The solver to free.
+ */ 
+void free_solver(Solver* solver) {
+    free(solver->holding);
+    free(solver->counts);
+    free(solver->ownerKeys);
+    free(solver->leadKeys);
+    free(solver->specialKeys);
+    free(solver->seatKeys);
+    free(solver->table);
+}
+
+/**
+ * Deal a deck to the players as deal_cards does, in contiguous blocks.
+ *
+ * @param solver - The solver to deal to.
+ * @param deck - The deck to deal.
+ * @return Whether the hands can be solved.
+ */ 
+bool deal_solver(Solver* solver, const Deck* deck) {
+    solver->handSize = deck->size / solver->playerCount;
+    solver->present = 0;
+    solver->specialsLeft = 0;
+    memset(solver->remaining, 0, sizeof(solver->remaining));
+    memset(solver->owners, 0, sizeof(solver->owners));
+    memset(solver->holding, 0, sizeof(uint64_t) * solver->playerCount);
+    memset(solver->counts, 0, CARD_COUNT * solver->playerCount);
+
+    for (int i = 0; i < solver->playerCount; i++) {
+        for (int j = 0; j < solver->handSize; j++) {
+            int card = deck->cards[i * solver->handSize + j];
+            if (solver->counts[i * CARD_COUNT + card] == MAX_COPIES) {
+                return false;
+            }
+            give_to(solver, i, card);
+            solver->specialsLeft += card >> 4 == solver->specialSuit;
+        }
+    }
+    return solver->handSize > 0;
+}
+
+/**
+ * Find the best score a seat can guarantee, whatever the others play. If 
+ * the search reaches the solvers limit first, the score is only narrowed 
+ * down as far as it got.
+ *
+ * @param solver - The solver, dealt the deck to solve.
+ * @param seat - The player to solve for.
+ * @param lower - Set to the least the score can be.
+ * @param upper - Set to the most the score can be.
+ * @return Whether the score was found, so the two are equal.
+ */ 
+bool solve_seat(Solver* solver, int seat, int* lower, int* upper) {
+    solver->seat = seat;
+    solver->generation++;
+    solver->exhausted = false;
+    solver->score = 0;
+    solver->specialCards = 0;
+    solver->roundsLeft = solver->handSize;
+
+    // The first player leads the first round. Each search only asks 
+    // whether the score reaches a guess, which prunes far more than one 
+    // wide search, and the guesses close in on the score.
+    Trick trick = {.played = 0, .top = -1, .winner = 0, .specials = 0};
+    score_range(solver, lower, upper);
+    while (*lower < *upper) {
+        int guess = *lower + (*upper - *lower + 1) / 2;
+        int value = search(solver, 0, trick, guess - 1, guess);
+        if (solver->exhausted) {
+            return false;
+        } else if (value >= guess) {
+            *lower = value;
+        } else {
+            *upper = value;
+        }
+    }
+    return true;
+}
+
+/**
+ * Give a player a copy of a card.
+ *
+ * @param solver - The solver.
+ * @param player - The player to give it to.
+ * @param card - The card.
+ */ 
+void give_to(Solver* solver, int player, int card) {
+    solver->counts[player * CARD_COUNT + card]++;
+    solver->holding[player] |= 1ULL << card;
+    solver->present |= 1ULL << card;
+    solver->remaining[card]++;
+    solver->owners[card] += solver->ownerKeys[player];
+}
+
+/**
+ * Take a copy of a card from a player.
+ *
+ * @param solver - The solver.
+ * @param player - The player holding it.
+ * @param card - The card.
+ */ 
+void take_from(Solver* solver, int player, int card) {
+    if (!--solver->counts[player * CARD_COUNT + card]) {
+        solver->holding[player] &= ~(1ULL << card);
+    }
+    if (!--solver->remaining[card]) {
+        solver->present &= ~(1ULL << card);
+    }
+    solver->owners[card] -= solver->ownerKeys[player];
+}
+
+/**
+ * Hash the cards still held by where they stand in their suit rather than 
+ * by what they are, so positions that only differ in cards nobody can 
+ * tell apart any more share an entry in the table.
+ *
+ * @param solver - The solver.
+ * @return The key of the cards still held.
+ */ 
+uint64_t position_key(Solver* solver) {
+    uint64_t key = 0;
+    for (int suit = 0; suit < SUIT_COUNT; suit++) {
+        uint64_t cards = solver->present & SUIT_MASK << suit * RANK_COUNT;
+        for (; cards; cards &= cards - 1) {
+            key = (key ^ solver->owners[__builtin_ctzll(cards)]) 
+                    * KEY_MULTIPLIER;
+            key ^= key >> KEY_SHIFT;
+        }
+        // Mark the end of each suit.
+        key = (key + 1) * KEY_MULTIPLIER;
+    }
+    return key;
+}
+
+/**
+ * Search the moves of one player with alpha-beta pruning. The seat being 
+ * solved for maximises its score and every other player minimises it.
+ *
+ * @param solver - The solver.
+ * @param turn - The player to move.
+ * @param trick - The cards played so far this round.
+ * @param alpha - The score the seat can already guarantee.
+ * @param beta - The score the others can already hold the seat to.
+ * @return The score of the position, exact if it is between alpha and beta 
+ *      and otherwise a bound on it.
+ */ 
+int search(Solver* solver, int turn, Trick trick, int alpha, int beta) {
+    if (trick.played == solver->playerCount) {
+        return end_trick(solver, trick, alpha, beta);
+    }
+    // Once the limit is reached every value is meaningless, so nothing is 
+    // searched or remembered.
+    if (++solver->nodes > solver->limit) {
+        solver->exhausted = true;
+        return alpha;
+    }
+
+    // Positions are only remembered between rounds.
+    TableEntry* entry = NULL;
+    uint64_t key = 0;
+    int offset = 0;
+    int first = NO_MOVE;
+    int value;
+    int low = alpha;
+    int high = beta;
+    if (trick.played == 0) {
+        if (solver->roundsLeft == 0) {
+            return final_score(solver->score, solver->specialCards, 
+                    solver->threshold);
+        } else if (score_bounds(solver, alpha, beta, &value)) {
+            return value;
+        }
+        // Past the threshold every D card adds to the score, so the rest 
+        // of the game no longer depends on how many were won.
+        int won = (solver->specialCards < solver->threshold) 
+                ? solver->specialCards : solver->threshold;
+        offset = solver->score + ((won == solver->threshold) 
+                ? solver->specialCards : 0);
+        key = position_key(solver) ^ solver->leadKeys[turn] 
+                ^ solver->specialKeys[won] ^ solver->seatKeys[solver->seat];
+        entry = &solver->table[key & (TABLE_SIZE - 1)];
+        if (entry->key == key && entry->generation == solver->generation) {
+            value = entry->value + offset;
+            if (entry->bound == BOUND_EXACT 
+                    || (entry->bound == BOUND_LOWER && value >= beta) 
+                    || (entry->bound == BOUND_UPPER && value <= alpha)) {
+                return value;
+            }
+            first = entry->move;
+        }
+    }
+
+    Move moves[CARD_COUNT];
+    int count = order_moves(solver, turn, &trick, first, moves);
+    bool maximising = turn == solver->seat;
+    int best = maximising ? -SCORE_INFINITY : SCORE_INFINITY;
+    int bestMove = NO_MOVE;
+    for (int i = 0; i < count && alpha < beta; i++) {
+        int card = moves[i].card;
+        Trick next = trick;
+        if (trick.played == 0 
+                || (card >> 4 == trick.top >> 4 && card > trick.top)) {
+            next.top = card;
+            next.winner = turn;
+        }
+        next.specials += card >> 4 == solver->specialSuit;
+        next.played++;
+
+        take_from(solver, turn, card);
+        value = search(solver, (turn + 1) % solver->playerCount, next, 
+                alpha, beta);
+        give_to(solver, turn, card);
+
+        if (maximising ? value > best : value < best) {
+            best = value;
+            bestMove = moves[i].relative;
+        }
+        if (maximising && best > alpha) {
+            alpha = best;
+        } else if (!maximising && best < beta) {
+            beta = best;
+        }
+    }
+
+    if (entry && !solver->exhausted) {
+        *entry = (TableEntry) {.key = key, .generation = solver->generation, 
+                .value = best - offset, .move = bestMove, 
+                .bound = (best <= low) ? BOUND_UPPER 
+                : (best >= high) ? BOUND_LOWER : BOUND_EXACT};
+    }
+    return best;
+}
+
+/**
+ * Give the winner of a round its cards and search the next round.
+ *
+ * @param solver - The solver.
+ * @param trick - The finished round.
+ * @param alpha - The score the seat can already guarantee.
+ * @param beta - The score the others can already hold the seat to.
+ * @return The score of the position, as search gives it.
+ */ 
+int end_trick(Solver* solver, Trick trick, int alpha, int beta) {
+    bool won = trick.winner == solver->seat;
+    solver->score += won;
+    solver->specialCards += won ? trick.specials : 0;
+    solver->roundsLeft--;
+    solver->specialsLeft -= trick.specials;
+
+    // The winner leads the next round.
+    Trick next = {.played = 0, .top = -1, .winner = trick.winner, 
+            .specials = 0};
+    int value = search(solver, trick.winner, next, alpha, beta);
+
+    solver->score -= won;
+    solver->specialCards -= won ? trick.specials : 0;
+    solver->roundsLeft++;
+    solver->specialsLeft += trick.specials;
+    return value;
+}
+
+/**
+ * List the cards a player can play that lead to different positions, most 
+ * promising first: the best move remembered, then the cheapest card that 
+ * takes the round from or for the seat, then the lowest cards.
+ *
+ * @param solver - The solver.
+ * @param turn - The player to move.
+ * @param trick - The cards played so far this round.
+ * @param first - The card to try first, as Move.relative gives it, or 
+ *      NO_MOVE.
+ * @param moves - Filled with each card to try.
+ * @return The number of moves.
+ */ 
+int order_moves(Solver* solver, int turn, const Trick* trick, int first, 
+        Move* moves) {
+    uint64_t own = solver->holding[turn];
+    uint64_t others = 0;
+    int priorities[CARD_COUNT];
+    int count = 0;
+    for (int i = 0; i < solver->playerCount; i++) {
+        others |= (i == turn) ? 0 : solver->holding[i];
+    }
+
+    int previous = -1;
+    for (uint64_t cards = own; cards; cards &= cards - 1) {
+        int card = __builtin_ctzll(cards);
+        // A card is no different to the next lower one held if nobody else 
+        // holds a card from one to the other, and the round so far doesn't 
+        // fall between them.
+        if (previous != -1 && previous >> 4 == card >> 4 
+                && !(others & ((2ULL << card) - (1ULL << previous))) 
+                && !(trick->played > 0 && trick->top >= previous 
+                && trick->top < card)) {
+            previous = card;
+            continue;
+        }
+        previous = card;
+
+        int suit = card >> 4;
+        int rank = card & 0xf;
+        int relative = suit << 4 | __builtin_popcountll(solver->present 
+                & ((2ULL << card) - (1ULL << (suit << 4))));
+        bool takes = suit == trick->top >> 4 && card > trick->top;
+        int priority;
+        if (relative == first) {
+            priority = SCORE_INFINITY;
+        } else if (trick->played == 0) {
+            priority = -rank;
+        } else if (takes && (turn == solver->seat 
+                || trick->winner == solver->seat)) {
+            priority = RANK_COUNT - rank;
+        } else {
+            priority = -rank;
+        }
+
+        int i = count++;
+        for (; i > 0 && priorities[i - 1] < priority; i--) {
+            priorities[i] = priorities[i - 1];
+            moves[i] = moves[i - 1];
+        }
+        priorities[i] = priority;
+        moves[i] = (Move) {.card = card, .relative = relative};
+    }
+    return count;
+}
+
+/**
+ * Bound the final score of the seat from the cards left to play, to end 
+ * the search of positions that cannot change the result.
+ *
+ * @param solver - The solver, between rounds.
+ * @param alpha - The score the seat can already guarantee.
+ * @param beta - The score the others can already hold the seat to.
+ * @param value - Set to the bound that ends the search.
+ * @return Whether the search can end.
+ */ 
+bool score_bounds(Solver* solver, int alpha, int beta, int* value) {
+    int lower, upper;
+    score_range(solver, &lower, &upper);
+    if (upper <= alpha || upper == lower) {
+        *value = upper;
+        return true;
+    } else if (lower >= beta) {
+        *value = lower;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Bound the final score of the seat from the cards left to play.
+ *
+ * @param solver - The solver, between rounds.
+ * @param lower - Set to the least the score can be.
+ * @param upper - Set to the most the score can be.
+ */ 
+void score_range(Solver* solver, int* lower, int* upper) {
+    int most = solver->specialCards + solver->specialsLeft;
+    *upper = solver->score + solver->roundsLeft 
+            + ((most >= solver->threshold) ? most : -solver->specialCards);
+    *lower = (solver->specialCards >= solver->threshold) 
+            ? solver->score + solver->specialCards 
+            : solver->score - ((most < solver->threshold) ? most 
+            : solver->threshold - 1);
+}
+
+/**
+ * Output a value for each seat to stdout
+ *
+ * @param name - What the values are.
+ * @param scores - The value of each seat.
+ * @param playerCount - The number of players.
+ */ 
+void output_seats(const char* name, const int* scores, int playerCount) {
+    printf("%s=", name);
+    output_scores((int*) scores, playerCount);
+}
+
+/**
+ * Output the optimal score of each seat, or the bounds found on it when 
+ * the seat could not be solved, as least..most.
+ *
+ * @param lower - The least each score can be.
+ * @param upper - The most each score can be.
+ * @param playerCount - The number of players.
+ */ 
+void output_bounds(const int* lower, const int* upper, int playerCount) {
+    printf("Optimal=");
+    for (int i = 0; i < playerCount; i++) {
+        printf((i == 0) ? "%d:%d" : " %d:%d", i, lower[i]);
+        if (lower[i] != upper[i]) {
+            printf("..%d", upper[i]);
+        }
+    }
+    printf("\n");
+}
+
+/* Exits the solver with specifid error Code
+ *
+ * @param exitCode - what to exit with
+ */
+void exit_solver(int exitCondition) {
+    const char* messages[] = {"",
+            "Usage: 2310solver [-t] [-b nodes] deck threshold player0 "
+            "{player1}\n"
+            "Each deal may search nodes positions (" 
+            NUMBER_TEXT(SOLVER_BUDGET) " by default, 0 for no limit), "
+            "which\nsolves hands of up to 14 cards for two players, 8 for "
+            "three and 6 for four.\nMost such deals take a few "
+            "milliseconds, but some take a few hundred and use\nmost of "
+            "the budget. Deals left unsolved report bounds on each score "
+            "as\nleast..most.\n",
+            "Invalid threshold\n",
+            "Deck error\n",
+            "Not enough cards\n",
+            "Player error\n"};
+    fputs(messages[exitCondition], stderr);
+    exit(exitCondition);
+}
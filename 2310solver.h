@@ -0,0 +1,151 @@
+#ifndef _2310SOLVER_H_
+#define _2310SOLVER_H_
+
+#include <getopt.h>
+#include <time.h>
+#include "game.h"
+#include "runner.h"
+
+#define SOLVER_OPTIONS "+tb:"
+#define SOLVER_ARGS 3
+#define CARD_COUNT (SUIT_COUNT * RANK_COUNT)
+#define MAX_COPIES 0xff
+#define SUIT_MASK 0xffffULL
+#define TABLE_BITS 20
+#define TABLE_SIZE (1 << TABLE_BITS)
+#define NO_MOVE 0xff
+#define SOLVER_SEED 2310
+#define SCORE_INFINITY (1 << 14)
+#define KEY_MULTIPLIER 0x9e3779b97f4a7c15ULL
+#define KEY_SHIFT 29
+#define SOLVER_BUDGET 4000000
+#define TEXT_OF(value) #value
+#define NUMBER_TEXT(value) TEXT_OF(value)
+#define NO_BUDGET 0
+
+#define BOUND_EXACT 0
+#define BOUND_LOWER 1
+#define BOUND_UPPER 2
+
+/**
+ * A position the solver has already searched.
+ * 
+ * @param key - The hash of the position, as position_key makes it
+ * @param generation - The deal and seat searched, so the table needn't be 
+ *      cleared between them
+ * @param value - Its score for the seat, less what was already won
+ * @param bound - Whether the value is exact or only a bound
+ * @param move - The best card found, as Move.relative gives it
+ */ 
+typedef struct {
+    uint64_t key;
+    uint32_t generation;
+    int16_t value;
+    uint8_t bound;
+    uint8_t move;
+} TableEntry;
+
+/**
+ * The state of a search for the best score one seat can guarantee, 
+ * assuming every other player plays against it. Cards are numbered as 
+ * encode_card packs them, so each suit is a run of RANK_COUNT bits.
+ * 
+ * @param playerCount - The number of players
+ * @param threshold - The number of D cards needed for an additional score
+ * @param handSize - The cards dealt to each player
+ * @param seat - The player being solved for
+ * @param specialSuit - The suit of D cards, as encode_card packs it
+ * @param holding - For each player, the cards it holds at least one of
+ * @param counts - For each player, how many of each card it holds
+ * @param present - The cards anyone holds
+ * @param remaining - How many of each card are held by anyone
+ * @param owners - The sum of the keys of the players holding each card
+ * @param ownerKeys - A random key for each player holding a card
+ * @param leadKeys - A random key for each player leading
+ * @param specialKeys - A random key for each count of D cards won
+ * @param seatKeys - A random key for each seat solved for
+ * @param score - Rounds won by the seat
+ * @param specialCards - D cards won by the seat
+ * @param roundsLeft - Rounds left to play
+ * @param specialsLeft - D cards left to play
+ * @param table - Positions already searched
+ * @param generation - The generation of the current search
+ * @param nodes - The number of positions visited
+ * @param limit - The number of positions visited at which to give up
+ * @param exhausted - Whether the search gave up on reaching the limit
+ */ 
+typedef struct {
+    int playerCount;
+    int threshold;
+    int handSize;
+    int seat;
+    int specialSuit;
+    uint64_t* holding;
+    uint8_t* counts;
+    uint64_t present;
+    int remaining[CARD_COUNT];
+    uint64_t owners[CARD_COUNT];
+    uint64_t* ownerKeys;
+    uint64_t* leadKeys;
+    uint64_t* specialKeys;
+    uint64_t* seatKeys;
+    int score;
+    int specialCards;
+    int roundsLeft;
+    int specialsLeft;
+    TableEntry* table;
+    uint32_t generation;
+    long nodes;
+    long limit;
+    bool exhausted;
+} Solver;
+
+/**
+ * The cards played so far in a round.
+ * 
+ * @param played - The number of cards played
+ * @param top - The winning card so far
+ * @param winner - The player of the winning card
+ * @param specials - D cards played this round
+ */ 
+typedef struct {
+    int played;
+    int top;
+    int winner;
+    int specials;
+} Trick;
+
+/**
+ * A card a player could play.
+ * 
+ * @param card - The card
+ * @param relative - Its suit and place among the cards of that suit still 
+ *      held, which means the same in positions sharing a key
+ */ 
+typedef struct {
+    int card;
+    int relative;
+} Move;
+
+/* Solving */
+void init_solver(Solver* solver, int playerCount, int threshold);
+void free_solver(Solver* solver);
+bool deal_solver(Solver* solver, const Deck* deck);
+bool solve_seat(Solver* solver, int seat, int* lower, int* upper);
+int search(Solver* solver, int turn, Trick trick, int alpha, int beta);
+int end_trick(Solver* solver, Trick trick, int alpha, int beta);
+int order_moves(Solver* solver, int turn, const Trick* trick, int first, 
+        Move* moves);
+uint64_t position_key(Solver* solver);
+void take_from(Solver* solver, int player, int card);
+void give_to(Solver* solver, int player, int card);
+bool score_bounds(Solver* solver, int alpha, int beta, int* value);
+void score_range(Solver* solver, int* lower, int* upper);
+
+/* Command line */
+bool load_solver_decks(bool list, const char* path, DeckSet* decks);
+void output_seats(const char* name, const int* scores, int playerCount);
+void output_bounds(const int* lower, const int* upper, int playerCount);
+void exit_solver(int exitCondition);
+
+#endif // _2310SOLVER_H_
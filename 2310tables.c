@@ -0,0 +1,92 @@
+#include "2310tables.h"
+
+/**
+ * Compile strategy descriptions into C source for their tables, so the 
+ * shipped strategies are built from the same descriptions .strat players 
+ * are read from. Each table is named after its file, as aliceTable is 
+ * from alice.strat.
+ */ 
+int main(int argc, char** argv) {
+    if (argc < TABLES_ARGS) {
+        exit_tables(ERROR_TABLES_ARGS);
+    }
+    printf(TABLES_HEADER);
+    for (int i = 1; i < argc; i++) {
+        StrategyTable table;
+        char* name = table_name(argv[i]);
+        if (!name || !read_table(argv[i], &table)) {
+            exit_tables(ERROR_TABLES_STRATEGY);
+        }
+        output_table(argv[i], name, &table);
+        free(name);
+    }
+    exit_tables(NORMAL_EXIT);
+}
+
+/**
+ * Find the name of the table a description compiles to.
+ * 
+ * @param path - The description, ending in .strat.
+ * @return The name of its file without the suffix, which the caller frees, 
+ *      or NULL if that is not a C identifier.
+ */ 
+char* table_name(const char* path) {
+    const char* file = strrchr(path, '/') ? strrchr(path, '/') + 1 : path;
+    int length = strlen(file) - strlen(TABLE_SUFFIX);
+    if (length < 1 || strcmp(file + length, TABLE_SUFFIX) 
+            || isdigit(file[0])) {
+        return NULL;
+    }
+    for (int i = 0; i < length; i++) {
+        if (!isalnum(file[i]) && file[i] != '_') {
+            return NULL;
+        }
+    }
+    return strndup(file, length);
+}
+
+/**
+ * Output the definition of a table, with a rule for each situation.
+ * 
+ * @param path - The description it was compiled from.
+ * @param name - The name of the table, less Table.
+ * @param table - The table.
+ */ 
+void output_table(const char* path, const char* name, 
+        const StrategyTable* table) {
+    printf("\n/* %s */\nconst StrategyTable %sTable = {.rules = {", path, 
+            name);
+    for (int i = 0; i < SITUATION_COUNT; i++) {
+        printf(i ? ",\n        {" : "\n        {");
+        output_rule(&table->rules[i][false]);
+        printf(", ");
+        output_rule(&table->rules[i][true]);
+        printf("}");
+    }
+    printf("}};\n");
+}
+
+/**
+ * Output a rule as an initialiser.
+ * 
+ * @param rule - The rule.
+ */ 
+void output_rule(const Rule* rule) {
+    printf("{{");
+    for (int i = 0; i < rule->count; i++) {
+        printf(i ? ", %d" : "%d", rule->suits[i]);
+    }
+    printf("}, %d, %s}", rule->count, rule->highest ? "true" : "false");
+}
+
+/* Exits the table generator with specifid error Code
+ * 
+ * @param exitCode - what to exit with
+ */ 
+int exit_tables(int exitCondition) {
+    const char* messages[] = {"", 
+            "Usage: 2310tables description {description}\n", 
+            "Strategy error\n"};
+    fputs(messages[exitCondition], stderr);
+    exit(exitCondition);
+}
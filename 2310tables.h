@@ -0,0 +1,20 @@
+#ifndef _2310TABLES_H_
+#define _2310TABLES_H_
+
+#include <ctype.h>
+#include "rules.h"
+
+#define TABLES_ARGS 2
+#define TABLES_HEADER "/* Generated by 2310tables. Do not edit. */\n" \
+        "#include \"strategy.h\"\n"
+
+#define ERROR_TABLES_ARGS 1
+#define ERROR_TABLES_STRATEGY 2
+
+char* table_name(const char* path);
+void output_table(const char* path, const char* name, 
+        const StrategyTable* table);
+void output_rule(const Rule* rule);
+int exit_tables(int exitCondition);
+
+#endif // _2310TABLES_H_
@@ -0,0 +1,355 @@
+#include "deck.h"
+
+/**
+ * Read a deck from a file
+ * 
+ * @param path - The file holding the deck.
+ * @param deck - The deck to fill in.
+ * @return Whether the file held a valid deck.
+ */ 
+bool read_deck(const char* path, Deck* deck) {
+    int deckFile = open(path, O_RDONLY);
+    if (deckFile == -1) {
+        return false;
+    }
+
+    LineReader reader;
+    init_reader(&reader, deckFile);
+    char* line;
+    int lineN = 0;
+    bool valid = true;
+
+    if (!(line = next_line(&reader)) || (deck->size = read_int(line)) <= 0) {
+        free_reader(&reader);
+        close(deckFile);
+        return false;
+    }
+
+    deck->cards = malloc(deck->size);
+
+    while (valid && (line = next_line(&reader))) {
+        // check cards are within array size.
+        if (lineN >= deck->size || !check_card(line)) {
+            valid = false;
+        } else {
+            deck->cards[lineN++] = encode_card((Card) {.suit = line[0], 
+                    .rank = line[1]});
+        }
+    }
+
+    free_reader(&reader);
+    close(deckFile);
+    // check deck is not under sized.
+    if (!valid || lineN != deck->size) {
+        free(deck->cards);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Read every deck named in a file, one file name per line, or every deck 
+ * in a pack file.
+ * 
+ * @param path - The file listing the decks, or a pack.
+ * @param set - The decks that were read.
+ * @return Whether every listed deck was valid.
+ */ 
+bool read_deck_list(const char* path, DeckSet* set) {
+    int deckList = open(path, O_RDONLY);
+    if (deckList == -1) {
+        return false;
+    }
+
+    PackHeader header;
+    if (read(deckList, &header, sizeof(header)) == sizeof(header) 
+            && !memcmp(header.magic, PACK_MAGIC, PACK_MAGIC_SIZE)) {
+        bool mapped = map_pack(deckList, set);
+        close(deckList);
+        return mapped;
+    }
+    lseek(deckList, 0, SEEK_SET);
+
+    LineReader reader;
+    init_reader(&reader, deckList);
+    char* line;
+    int capacity = 1;
+    bool valid = true;
+    *set = (DeckSet) {.decks = malloc(sizeof(Deck) * capacity), 
+            .count = 0, .map = NULL, .pattern = {.cards = NULL}};
+
+    while (valid && (line = next_line(&reader))) {
+        // Allow blank lines between deck names.
+        if (line[0] != '\0') {
+            if (set->count == capacity) {
+                capacity *= 2;
+                set->decks = realloc(set->decks, sizeof(Deck) * capacity);
+            }
+            valid = read_deck(line, &set->decks[set->count]);
+            set->count += valid;
+        }
+    }
+    free_reader(&reader);
+    close(deckList);
+
+    if (!valid || set->count == 0) {
+        free_decks(set);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Read a single deck file as a set of one deck.
+ * 
+ * @param path - The deck file.
+ * @param set - The deck that was read.
+ * @return Whether the deck was valid.
+ */ 
+bool single_deck(const char* path, DeckSet* set) {
+    *set = (DeckSet) {.decks = malloc(sizeof(Deck)), .count = 1, 
+            .map = NULL, .pattern = {.cards = NULL}};
+    if (!read_deck(path, set->decks)) {
+        free(set->decks);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Find a deck in a set. Packed decks are not copied, so they stay valid 
+ * only as long as the set and must not be written to. Generated decks are 
+ * shuffled into the buffer.
+ * 
+ * @param set - The decks to look in.
+ * @param index - Which deck is wanted.
+ * @param buffer - Room for deck_buffer_size cards.
+ * @param deck - Set to the deck.
+ * @return Whether the deck exists and is not empty.
+ */ 
+bool deck_at(const DeckSet* set, int index, unsigned char* buffer, 
+        Deck* deck) {
+    if (index < 0 || index >= set->count) {
+        return false;
+    } else if (set->pattern.cards) {
+        shuffle_deck(&set->pattern, set->seed, index, buffer);
+        *deck = (Deck) {.cards = buffer, .size = set->pattern.size};
+        return true;
+    } else if (!set->map) {
+        *deck = set->decks[index];
+        return true;
+    }
+    uint64_t start = set->offsets[index];
+    uint64_t end = set->offsets[index + 1];
+    if (start >= end || end > set->offsets[set->count] 
+            || end - start > INT_MAX) {
+        return false;
+    }
+    *deck = (Deck) {.cards = set->cards + start, .size = end - start};
+    return true;
+}
+
+/**
+ * Find how much room deck_at needs to hand out a deck.
+ * 
+ * @param set - The decks that will be asked for.
+ * @return The number of cards the buffer must hold.
+ */ 
+int deck_buffer_size(const DeckSet* set) {
+    return set->pattern.cards ? set->pattern.size : 0;
+}
+
+/**
+ * Release every deck in a set.
+ * 
+ * @param set - The decks to free.
+ */ 
+void free_decks(DeckSet* set) {
+    if (set->pattern.cards) {
+        free(set->pattern.cards);
+        set->pattern.cards = NULL;
+    } else if (set->map) {
+        munmap(set->map, set->mapSize);
+        set->map = NULL;
+    } else {
+        for (int i = 0; i < set->count; i++) {
+            free(set->decks[i].cards);
+        }
+        free(set->decks);
+    }
+    set->decks = NULL;
+    set->count = 0;
+}
+
+/**
+ * Map a pack file so its decks can be used without reading them. The 
+ * cards were checked when the pack was written, so only the header and 
+ * the size of the index are checked here.
+ * 
+ * @param fd - The open pack file, which can be closed afterwards.
+ * @param set - The decks in the pack.
+ * @return Whether the file is a pack this hub understands.
+ */ 
+bool map_pack(int fd, DeckSet* set) {
+    struct stat info;
+    if (fstat(fd, &info) == -1 || info.st_size < sizeof(PackHeader)) {
+        return false;
+    }
+    void* map = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+
+    const PackHeader* header = map;
+    size_t cardStart = sizeof(PackHeader) 
+            + sizeof(uint64_t) * ((size_t) header->count + 1);
+    const uint64_t* offsets = (uint64_t*) ((char*) map + sizeof(PackHeader));
+    if (memcmp(header->magic, PACK_MAGIC, PACK_MAGIC_SIZE) 
+            || header->version != PACK_VERSION || header->count == 0 
+            || header->count > INT_MAX || cardStart > info.st_size 
+            || offsets[header->count] != info.st_size - cardStart) {
+        munmap(map, info.st_size);
+        return false;
+    }
+
+    *set = (DeckSet) {.decks = NULL, .count = header->count, .map = map, 
+            .mapSize = info.st_size, .offsets = offsets, 
+            .cards = (unsigned char*) map + cardStart, 
+            .pattern = {.cards = NULL}};
+    return true;
+}
+
+/**
+ * Write a set of decks as a pack file.
+ * 
+ * @param path - The file to create.
+ * @param set - The decks to pack.
+ * @return Whether the whole pack was written.
+ */ 
+bool write_pack(const char* path, const DeckSet* set) {
+    FILE* pack = fopen(path, "w");
+    if (!pack) {
+        return false;
+    }
+    PackHeader header = {.version = PACK_VERSION, .count = set->count};
+    memcpy(header.magic, PACK_MAGIC, PACK_MAGIC_SIZE);
+    bool written = fwrite(&header, sizeof(header), 1, pack) == 1;
+
+    Deck deck;
+    unsigned char* buffer = malloc(deck_buffer_size(set));
+    uint64_t offset = 0;
+    for (int i = 0; i <= set->count; i++) {
+        written &= fwrite(&offset, sizeof(offset), 1, pack) == 1;
+        if (i < set->count && deck_at(set, i, buffer, &deck)) {
+            offset += deck.size;
+        }
+    }
+    for (int i = 0; i < set->count; i++) {
+        if (deck_at(set, i, buffer, &deck)) {
+            written &= fwrite(deck.cards, 1, deck.size, pack) == deck.size;
+        }
+    }
+    free(buffer);
+    return !fclose(pack) && written;
+}
+
+/**
+ * Set up decks that are shuffled from a seed rather than read. The cards 
+ * are given as suits and ranks, optionally followed by how many copies of 
+ * each card there are, such as DHCS:123456789abcdef:2.
+ * 
+ * @param spec - The cards in every deck.
+ * @param count - The number of decks.
+ * @param seed - Decks with the same seed and index are always the same.
+ * @param set - The decks.
+ * @return Whether the spec was valid.
+ */ 
+bool generate_decks(const char* spec, int count, uint64_t seed, 
+        DeckSet* set) {
+    const char* ranks = strchr(spec, SPEC_SEPARATOR);
+    if (!ranks || count < 1) {
+        return false;
+    }
+    int suitCount = ranks++ - spec;
+    const char* copiesText = strchr(ranks, SPEC_SEPARATOR);
+    int rankCount = copiesText ? copiesText - ranks : strlen(ranks);
+    int copies = copiesText ? read_int((char*) copiesText + 1) : 1;
+
+    if (suitCount < 1 || rankCount < 1 || copies < 1 
+            || copies > INT_MAX / suitCount / rankCount) {
+        return false;
+    }
+    for (int i = 0; i < suitCount; i++) {
+        if (suit_index(spec[i]) == -1) {
+            return false;
+        }
+    }
+    for (int i = 0; i < rankCount; i++) {
+        if (rank_index(ranks[i]) == -1) {
+            return false;
+        }
+    }
+
+    *set = (DeckSet) {.decks = NULL, .count = count, .map = NULL, 
+            .seed = seed, .pattern = {.size = suitCount * rankCount * copies}};
+    set->pattern.cards = malloc(set->pattern.size);
+    int size = 0;
+    for (int i = 0; i < suitCount; i++) {
+        for (int j = 0; j < rankCount; j++) {
+            for (int k = 0; k < copies; k++) {
+                set->pattern.cards[size++] = encode_card((Card) {
+                        .suit = spec[i], .rank = ranks[j]});
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Fisher-Yates shuffle the cards of a generated deck. Every deck takes 
+ * one number per card from the same stream, so deck index starts that 
+ * many numbers in and decks never share numbers, whichever thread makes 
+ * them and in whatever order.
+ * 
+ * @param pattern - The cards to shuffle.
+ * @param seed - The seed of the stream.
+ * @param index - Which deck of the stream to make.
+ * @param cards - Room for the shuffled cards.
+ */ 
+void shuffle_deck(const Deck* pattern, uint64_t seed, int index, 
+        unsigned char* cards) {
+    Random random = {.state = seed};
+    jump_random(&random, (uint64_t) index * pattern->size);
+    memcpy(cards, pattern->cards, pattern->size);
+
+    for (int i = pattern->size - 1; i > 0; i--) {
+        // The modulo bias is below 2^-57 for any real deck.
+        int j = next_random(&random) % (i + 1);
+        unsigned char swap = cards[i];
+        cards[i] = cards[j];
+        cards[j] = swap;
+    }
+}
+
+/**
+ * Take the next number from a generator.
+ * 
+ * @param random - The generator.
+ * @return A uniformly distributed 64 bit number.
+ */ 
+uint64_t next_random(Random* random) {
+    uint64_t z = (random->state += RANDOM_GAMMA);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * Skip a generator ahead as if it had made some numbers.
+ * 
+ * @param random - The generator.
+ * @param steps - How many numbers to skip.
+ */ 
+void jump_random(Random* random, uint64_t steps) {
+    random->state += steps * RANDOM_GAMMA;
+}
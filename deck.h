@@ -0,0 +1,102 @@
+#ifndef _DECK_H_
+#define _DECK_H_
+
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "utilities.h"
+
+#define PACK_MAGIC "2310PACK"
+#define PACK_MAGIC_SIZE 8
+#define PACK_VERSION 1
+
+#define SPEC_SEPARATOR ':'
+#define RANDOM_GAMMA 0x9e3779b97f4a7c15ULL
+
+/**
+ * A deck of cards in the order they are dealt, one byte per card as made 
+ * by encode_card.
+ * 
+ * @param cards - All cards in the deck
+ * @param size - The number of cards
+ */ 
+typedef struct {
+    unsigned char* cards;
+    int size;
+} Deck;
+
+/**
+ * The start of a pack file. It is followed by count + 1 offsets, where 
+ * deck i is the bytes from offset i to offset i + 1 of the cards that 
+ * come after the offsets. Numbers are in the byte order of the host that 
+ * packed the file, which the version catches if it differs.
+ * 
+ * @param magic - PACK_MAGIC
+ * @param version - PACK_VERSION
+ * @param count - The number of decks
+ */ 
+typedef struct {
+    char magic[PACK_MAGIC_SIZE];
+    uint32_t version;
+    uint32_t count;
+} PackHeader;
+
+/**
+ * A splitmix64 generator. Its state only ever advances by RANDOM_GAMMA, 
+ * so jumping any distance ahead is a single multiply.
+ * 
+ * @param state - The position in the stream
+ */ 
+typedef struct {
+    uint64_t state;
+} Random;
+
+/**
+ * A collection of decks to play one after another. Decks are either read 
+ * from text files, are views into a mapped pack file or are shuffled from 
+ * a seed when they are asked for.
+ * 
+ * @param decks - Every deck read from text, NULL otherwise
+ * @param count - The number of decks
+ * @param map - The mapped pack file, NULL otherwise
+ * @param mapSize - The size of the mapping
+ * @param offsets - Where each packed deck starts in cards
+ * @param cards - The packed cards of every deck
+ * @param pattern - The cards every generated deck is a shuffle of, with 
+ *      no cards unless the set is generated
+ * @param seed - The seed generated decks are shuffled from
+ */ 
+typedef struct {
+    Deck* decks;
+    int count;
+    void* map;
+    size_t mapSize;
+    const uint64_t* offsets;
+    unsigned char* cards;
+    Deck pattern;
+    uint64_t seed;
+} DeckSet;
+
+/* Deck reading */
+bool read_deck(const char* path, Deck* deck);
+bool read_deck_list(const char* path, DeckSet* set);
+bool single_deck(const char* path, DeckSet* set);
+bool deck_at(const DeckSet* set, int index, unsigned char* buffer, 
+        Deck* deck);
+int deck_buffer_size(const DeckSet* set);
+void free_decks(DeckSet* set);
+
+/* Pack files */
+bool map_pack(int fd, DeckSet* set);
+bool write_pack(const char* path, const DeckSet* set);
+
+/* Generated decks */
+bool generate_decks(const char* spec, int count, uint64_t seed, 
+        DeckSet* set);
+void shuffle_deck(const Deck* pattern, uint64_t seed, int index, 
+        unsigned char* cards);
+uint64_t next_random(Random* random);
+void jump_random(Random* random, uint64_t steps);
+
+#endif // _DECK_H_
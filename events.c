@@ -0,0 +1,381 @@
+#include "events.h"
+
+/**
+ * Create an event loop with no channels.
+ * 
+ * @param loop - The loop to initialise.
+ * @param stallMillis - How long to wait before reporting a slow player.
+ * @return Whether the epoll instance could be created.
+ */ 
+bool init_loop(EventLoop* loop, int stallMillis) {
+    loop->stallMillis = stallMillis;
+    loop->writes = 0;
+    loop->messages = 0;
+    loop->interrupted = NULL;
+    loop->context = NULL;
+    loop->epoll = epoll_create1(EPOLL_CLOEXEC);
+    return loop->epoll != -1;
+}
+
+/**
+ * Wait for any channel to become ready and service it. Readable channels 
+ * are drained into their buffers and writable ones are flushed, so no 
+ * player blocks on a full pipe while the hub waits for another.
+ * 
+ * @param loop - The loop to wait on.
+ * @param timeout - Milliseconds to wait, or -1 to wait forever.
+ * @return The number of channels serviced.
+ */ 
+int poll_events(EventLoop* loop, int timeout) {
+    struct epoll_event events[MAX_EVENTS];
+    int ready = epoll_wait(loop->epoll, events, MAX_EVENTS, timeout);
+
+    if (ready < 0 && errno == EINTR && loop->interrupted) {
+        loop->interrupted(loop->context);
+    }
+    for (int i = 0; i < ready; i++) {
+        service_channel(events[i].data.ptr, events[i].events);
+    }
+    // Interrupted waits service nothing.
+    return (ready < 0) ? 0 : ready;
+}
+
+/**
+ * Drain a channel that is readable into its buffer, or flush one that is 
+ * writable.
+ * 
+ * @param channel - The channel epoll found ready.
+ * @param events - What epoll found.
+ */ 
+void service_channel(Channel* channel, uint32_t events) {
+    if (channel->kind == CHANNEL_WRITE) {
+        if (events & (EPOLLERR | EPOLLHUP)) {
+            // Epoll reports these whether or not they were asked for, so 
+            // a pipe nobody reads would otherwise be reported forever.
+            channel->closed = true;
+            channel->buffer.length = 0;
+            forget_channel(channel);
+        }
+        flush_channel(channel);
+    } else {
+        fill_channel(channel);
+    }
+}
+
+/**
+ * Tell the user once that a player has kept the hub waiting too long.
+ * 
+ * @param channel - The channel being waited on.
+ * @param start - When the wait began.
+ * @param reported - Whether the stall has already been reported.
+ * @return Whether the stall has now been reported.
+ */ 
+bool report_stall(Channel* channel, struct timespec* start, bool reported) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    long waited = (now.tv_sec - start->tv_sec) * 1000 
+            + (now.tv_nsec - start->tv_nsec) / 1000000;
+
+    if (!reported && channel->loop->stallMillis != NO_STALL 
+            && waited >= channel->loop->stallMillis) {
+        fprintf(stderr, "Player %d is slow (%ldms)\n", channel->player, 
+                waited);
+        return true;
+    }
+    return reported;
+}
+
+/**
+ * Start watching one end of a pipe.
+ * 
+ * @param channel - The channel to initialise.
+ * @param loop - The loop to watch it with.
+ * @param fd - The file descriptor of the pipe.
+ * @param kind - CHANNEL_READ, CHANNEL_WRITE or CHANNEL_ERROR.
+ * @param player - The player on the other end.
+ */ 
+void open_channel(Channel* channel, EventLoop* loop, int fd, int kind, 
+        int player) {
+    *channel = (Channel) {.kind = kind, .player = player, .closed = false,
+            .watching = false, .loop = loop, .bytes = 0, .calls = 0, 
+            .flushes = 0, .capture = NULL};
+    init_reader(&channel->buffer, fd);
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+    // Write channels are only watched while they have bytes waiting.
+    struct epoll_event event = {.events = (kind == CHANNEL_WRITE) 
+            ? 0 : EPOLLIN, .data.ptr = channel};
+    epoll_ctl(loop->epoll, EPOLL_CTL_ADD, fd, &event);
+}
+
+/**
+ * Stop watching a channel and close its pipe.
+ * 
+ * @param channel - The channel to close.
+ */ 
+void close_channel(Channel* channel) {
+    int* fd = &channel->buffer.fd;
+    if (*fd != -1) {
+        epoll_ctl(channel->loop->epoll, EPOLL_CTL_DEL, *fd, NULL);
+        close(*fd);
+        *fd = -1;
+    }
+    channel->closed = true;
+    free_reader(&channel->buffer);
+}
+
+/**
+ * Read everything available from a pipe into the channels buffer. Error 
+ * channels only need draining, so their bytes are captured or dropped.
+ * 
+ * @param channel - The channel to fill.
+ */ 
+void fill_channel(Channel* channel) {
+    int got;
+    do {
+        got = fill_reader(&channel->buffer);
+        channel->calls++;
+        channel->bytes += (got > 0) ? got : 0;
+        if (channel->kind == CHANNEL_ERROR) {
+            if (channel->capture && got > 0) {
+                capture_bytes(channel->capture, channel->buffer.data 
+                        + channel->buffer.start, channel->buffer.length);
+            }
+            channel->buffer.start = 0;
+            channel->buffer.length = 0;
+        }
+    } while (got > 0 || (got < 0 && errno == EINTR));
+
+    if (got == 0 || errno != EAGAIN) {
+        // The player has closed its end.
+        channel->closed = true;
+        forget_channel(channel);
+    }
+}
+
+/**
+ * Stop watching a channel whose player has closed its end. The pipe stays 
+ * open until the channel is closed.
+ * 
+ * @param channel - The channel to stop watching.
+ */ 
+void forget_channel(Channel* channel) {
+    epoll_ctl(channel->loop->epoll, EPOLL_CTL_DEL, channel->buffer.fd, NULL);
+    channel->watching = false;
+}
+
+/**
+ * Start capturing a players stderr.
+ * 
+ * @param capture - The capture to start.
+ * @param path - Append everything to this path followed by a dot and the 
+ *      player number, or NULL.
+ * @param player - The player whose stderr is captured.
+ * @param size - The bytes to keep in memory, or 0.
+ * @return Whether the file could be opened and the memory allocated.
+ */ 
+bool open_capture(Capture* capture, const char* path, int player, 
+        int size) {
+    *capture = (Capture) {.fd = -1, .tail = size ? malloc(size) : NULL,
+            .size = size, .end = 0, .length = 0};
+    if (path) {
+        char* name = malloc(strlen(path) + CHAR_BUFFER);
+        sprintf(name, "%s.%d", path, player);
+        capture->fd = open(name, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 
+                0644);
+        free(name);
+    }
+    return (!path || capture->fd != -1) && (!size || capture->tail);
+}
+
+/**
+ * Keep bytes drained from a players stderr.
+ * 
+ * @param capture - Where to keep them.
+ * @param bytes - The bytes.
+ * @param count - The number of bytes.
+ */ 
+void capture_bytes(Capture* capture, const char* bytes, int count) {
+    if (capture->fd != -1 && write(capture->fd, bytes, count) != count) {
+        // A full disk shouldn't end the game, so the file is given up on.
+        close(capture->fd);
+        capture->fd = -1;
+    }
+    if (!capture->tail) {
+        return;
+    }
+    // Only the last size bytes can be kept.
+    if (count > capture->size) {
+        bytes += count - capture->size;
+        count = capture->size;
+    }
+    int first = capture->size - capture->end;
+    first = (count < first) ? count : first;
+    memcpy(capture->tail + capture->end, bytes, first);
+    memcpy(capture->tail, bytes + first, count - first);
+    capture->end = (capture->end + count) % capture->size;
+    capture->length = (capture->length + count > capture->size) 
+            ? capture->size : capture->length + count;
+}
+
+/**
+ * Write the last of a players stderr to the hubs stderr.
+ * 
+ * @param capture - What was kept of it.
+ * @param player - The player it came from.
+ */ 
+void dump_capture(Capture* capture, int player) {
+    if (!capture->tail || !capture->length) {
+        return;
+    }
+    int start = (capture->end - capture->length + capture->size)
+            % capture->size;
+    int first = capture->size - start;
+    first = (capture->length < first) ? capture->length : first;
+
+    fprintf(stderr, "Player %d stderr (last %d bytes):\n", player, 
+            capture->length);
+    fwrite(capture->tail + start, 1, first, stderr);
+    fwrite(capture->tail, 1, capture->length - first, stderr);
+    if (capture->tail[(capture->end - 1 + capture->size) % capture->size] 
+            != '\n') {
+        fputc('\n', stderr);
+    }
+}
+
+/**
+ * Add a formatted message to the bytes waiting to be written.
+ * 
+ * @param channel - The channel to write to.
+ * @param format - A printf style format.
+ */ 
+void queue_message(Channel* channel, const char* format, ...) {
+    LineReader* buffer = &channel->buffer;
+    va_list args;
+    int space, needed;
+    do {
+        space = buffer->capacity - buffer->start - buffer->length;
+        va_start(args, format);
+        needed = vsnprintf(buffer->data + buffer->start + buffer->length, 
+                space, format, args);
+        va_end(args);
+
+        if (needed >= space) {
+            // Compact and grow, then format again.
+            reserve_channel(channel, needed + 1);
+        }
+    } while (needed >= space);
+    buffer->length += needed;
+}
+
+/**
+ * Add a message in the binary protocol to the bytes waiting to be written.
+ * 
+ * @param channel - The channel to write to.
+ * @param message - The message to encode.
+ */ 
+void queue_encoded(Channel* channel, const Message* message) {
+    int needed = encoded_size(message);
+    channel->buffer.length += encode_message(message, 
+            (unsigned char*) reserve_channel(channel, needed));
+}
+
+/**
+ * Add bytes that are already formatted to those waiting to be written.
+ * 
+ * @param channel - The channel to write to.
+ * @param bytes - The bytes to add.
+ * @param count - The number of bytes.
+ */ 
+void queue_bytes(Channel* channel, const char* bytes, int count) {
+    memcpy(reserve_channel(channel, count), bytes, count);
+    channel->buffer.length += count;
+}
+
+/**
+ * Make room for more bytes at the end of a channels buffer.
+ * 
+ * @param channel - The channel to grow.
+ * @param needed - The number of bytes to make room for.
+ * @return Where the bytes should be written. The caller adds them to the 
+ *      channels length once they are.
+ */ 
+char* reserve_channel(Channel* channel, int needed) {
+    LineReader* buffer = &channel->buffer;
+    if (buffer->start + buffer->length + needed > buffer->capacity) {
+        memmove(buffer->data, buffer->data + buffer->start, buffer->length);
+        buffer->start = 0;
+        while (buffer->capacity < buffer->length + needed) {
+            buffer->capacity *= 2;
+        }
+        buffer->data = realloc(buffer->data, buffer->capacity);
+    }
+    return buffer->data + buffer->start + buffer->length;
+}
+
+/**
+ * Write as much of a channels waiting bytes as the pipe will take. Any 
+ * remainder is written by the event loop once the pipe drains.
+ * 
+ * @param channel - The channel to flush.
+ * @return Whether the player is still reading.
+ */ 
+bool flush_channel(Channel* channel) {
+    LineReader* buffer = &channel->buffer;
+    int sent = 0;
+    channel->flushes++;
+    while (!channel->closed && buffer->length > 0 && (sent = write( 
+            buffer->fd, buffer->data + buffer->start, buffer->length)) != 0) {
+        channel->calls++;
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            } else if (errno != EAGAIN) {
+                // Nobody is left to read the bytes.
+                channel->closed = true;
+                buffer->length = 0;
+                forget_channel(channel);
+            }
+            break;
+        }
+        buffer->start += sent;
+        buffer->length -= sent;
+        channel->bytes += sent;
+        channel->loop->writes++;
+    }
+    if (buffer->length == 0) {
+        buffer->start = 0;
+    }
+
+    // Only watch for the pipe draining while there is more to send.
+    bool watch = !channel->closed && buffer->length > 0;
+    if (!channel->closed && watch != channel->watching) {
+        struct epoll_event event = {.events = watch ? EPOLLOUT : 0, 
+                .data.ptr = channel};
+        epoll_ctl(channel->loop->epoll, EPOLL_CTL_MOD, buffer->fd, &event);
+        channel->watching = watch;
+    }
+    return !channel->closed;
+}
+
+/**
+ * Wait for a single byte to arrive on a channel.
+ * 
+ * @param channel - The channel to read from.
+ * @return The byte that was read, or EOF if the pipe closed first.
+ */ 
+int wait_for_char(Channel* channel) {
+    struct timespec start;
+    bool reported = false;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    while (channel->buffer.length == 0) {
+        if (channel->closed) {
+            return EOF;
+        } else {
+            poll_events(channel->loop, channel->loop->stallMillis);
+            reported = report_stall(channel, &start, reported);
+        }
+    }
+    return *(unsigned char*) take_bytes(&channel->buffer, 1);
+}
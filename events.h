@@ -0,0 +1,113 @@
+#ifndef _EVENTS_H_
+#define _EVENTS_H_
+
+#include <stdarg.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include "utilities.h"
+
+#define MAX_EVENTS 64
+#define NO_STALL -1
+
+#define CHANNEL_READ 0
+#define CHANNEL_WRITE 1
+#define CHANNEL_ERROR 2
+
+/**
+ * An epoll instance watching the pipes of every player.
+ * 
+ * @param epoll - The epoll file descriptor
+ * @param stallMillis - How long to wait before reporting a slow player, 
+ *      or NO_STALL to never report
+ * @param writes - The number of write calls made to player pipes
+ * @param messages - The number of messages queued to players
+ * @param interrupted - Called with context when a signal interrupts a 
+ *      wait, outside the handler, or NULL
+ * @param context - Passed to interrupted, and what owns the loop when 
+ *      several share one epoll instance
+ */ 
+typedef struct {
+    int epoll;
+    int stallMillis;
+    long writes;
+    long messages;
+    void (*interrupted)(void* context);
+    void* context;
+} EventLoop;
+
+/**
+ * What is kept of a players stderr as it is drained. Everything can be 
+ * appended to a file, and the last of it kept in memory to show if the 
+ * game goes wrong.
+ * 
+ * @param fd - The file everything is appended to, or -1
+ * @param tail - The last bytes, wrapping around at size, or NULL
+ * @param size - The size of tail
+ * @param end - Where the next byte goes in tail
+ * @param length - The bytes held in tail, at most size
+ */ 
+typedef struct {
+    int fd;
+    char* tail;
+    int size;
+    int end;
+    int length;
+} Capture;
+
+/**
+ * One end of a non-blocking pipe and the bytes waiting on it. For read 
+ * and error channels this is what the player sent that has not been used, 
+ * for write channels what has been queued but not yet sent.
+ * 
+ * @param kind - CHANNEL_READ, CHANNEL_WRITE or CHANNEL_ERROR
+ * @param player - The player on the other end
+ * @param buffer - The pipe and its waiting bytes
+ * @param closed - Whether the other end has closed the pipe
+ * @param watching - Whether epoll is waiting for the pipe to be writable
+ * @param loop - The event loop watching the pipe
+ * @param bytes - The bytes read or written through the pipe
+ * @param calls - The read or write calls made on the pipe
+ * @param flushes - The times the channel was asked to flush
+ * @param capture - Where an error channels bytes are kept, or NULL to 
+ *      drop them
+ */ 
+typedef struct {
+    int kind;
+    int player;
+    LineReader buffer;
+    bool closed;
+    bool watching;
+    EventLoop* loop;
+    long bytes;
+    long calls;
+    long flushes;
+    Capture* capture;
+} Channel;
+
+/* Event loop */
+bool init_loop(EventLoop* loop, int stallMillis);
+int poll_events(EventLoop* loop, int timeout);
+void service_channel(Channel* channel, uint32_t events);
+bool report_stall(Channel* channel, struct timespec* start, bool reported);
+
+/* Channels */
+void open_channel(Channel* channel, EventLoop* loop, int fd, int kind, 
+        int player);
+void close_channel(Channel* channel);
+void fill_channel(Channel* channel);
+void forget_channel(Channel* channel);
+void queue_message(Channel* channel, const char* format, ...);
+void queue_encoded(Channel* channel, const Message* message);
+bool open_capture(Capture* capture, const char* path, int player, 
+        int size);
+void capture_bytes(Capture* capture, const char* bytes, int count);
+void dump_capture(Capture* capture, int player);
+void queue_bytes(Channel* channel, const char* bytes, int count);
+char* reserve_channel(Channel* channel, int needed);
+bool flush_channel(Channel* channel);
+int wait_for_char(Channel* channel);
+
+#endif // _EVENTS_H_
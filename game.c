@@ -0,0 +1,674 @@
+#include "game.h"
+
+/**
+ * Deal a new deck to the existing players and reset their state.
+ *
+ * @param game - Information about the game state.
+ * @return The error encountered, otherwise NORMAL_EXIT.
+ */ 
+int new_game(HubInfo* game) {
+    for (int i = 0; i < game->playerCount; i++) {
+        free(game->players[i].hand);
+        game->players[i].hand = NULL;
+    }
+
+    int status = deal_cards(game);
+    if (status != NORMAL_EXIT) {
+        return status;
+    }
+    // Every hand is the same size.
+    broadcast(game, &(Message) {.type = MESSAGE_NEWGAME, 
+            .count = game->round}, NO_PLAYER);
+    for (int i = 0; i < game->playerCount; i++) {
+        game->players[i].score = 0;
+        game->players[i].specialCards = 0;
+        send_hand(game, i);
+    }
+    return NORMAL_EXIT;
+}
+
+/**
+ * Play a game through, waiting on players whenever it has to.
+ *
+ * @param game - Information about the game state.
+ * @return The error encountered, otherwise NORMAL_EXIT.
+ */ 
+int run_game(HubInfo* game) {
+    int status;
+    start_game(game);
+    while ((status = advance_game(game)) == GAME_WAITING) {
+        await_play(game);
+    }
+    return status;
+}
+
+/**
+ * Set a game up to be advanced from its first round.
+ *
+ * @param game - Information about the game state.
+ */ 
+void start_game(HubInfo* game) {
+    // Tables can be too large to keep this on the stack.
+    game->turn = (Turn) {.winner = 0, .cardCount = game->playerCount, 
+            .played = malloc(sizeof(Card) * game->playerCount), 
+            .asked = false};
+    game->specialsPlayed = 0;
+}
+
+/**
+ * Play a game on until it is over, or until it has to wait on a player 
+ * for its card. Any number of games can be interleaved on one thread this 
+ * way, each advanced again once the player it waits on is ready.
+ *
+ * @param game - Information about the game state.
+ * @return GAME_WAITING if the current player has not played yet, the 
+ *      error encountered, or NORMAL_EXIT once the game has been scored.
+ */ 
+int advance_game(HubInfo* game) {
+    Turn* turn = &game->turn;
+    int status = NORMAL_EXIT;
+    while (status == NORMAL_EXIT 
+            && (turn->cardCount < game->playerCount || game->round > 0)) {
+        if (turn->cardCount == game->playerCount) {
+            game->round--;
+            begin_round(game);
+        }
+        status = take_turn(game);
+    }
+    if (status == GAME_WAITING) {
+        return status;
+    }
+    free(turn->played);
+    if (status == NORMAL_EXIT) {
+        score_game(game);
+    }
+    return status;
+}
+
+/**
+ * Wait until the player a game is waiting on might have played, servicing 
+ * every other pipe meanwhile. Players with mailboxes are slept on, with 
+ * the pipes serviced every so often, which is also when a player that has 
+ * died is noticed.
+ *
+ * @param game - Information about the game state.
+ */ 
+void await_play(HubInfo* game) {
+    Turn* turn = &game->turn;
+    Player* player = &game->players[turn->current];
+    if (!player->mailbox) {
+        poll_events(game->events, game->events->stallMillis);
+    } else if (!await_reply(game->ring, player->mailbox, player->replies, 
+            MAILBOX_POLL_MILLIS)) {
+        poll_events(game->events, 0);
+        if (game->metrics) {
+            check_metrics(game);
+        }
+    }
+    turn->reported = report_stall(&player->read, &turn->askedAt, 
+            turn->reported);
+}
+
+/**
+ * Start a round, led by the winner of the last.
+ *
+ * @param game - Information about the game state.
+ */ 
+void begin_round(HubInfo* game) {
+    Turn* turn = &game->turn;
+    turn->current = turn->winner;
+    turn->cardCount = 0;
+    turn->specials = 0;
+    turn->lead = (Card) {.suit = DORMANT_CHAR, .rank = DORMANT_CHAR};
+
+    send_new_round(game, turn->winner);
+    if (game->report) {
+        report_lead(game->report, turn->winner);
+    }
+}
+
+/**
+ * Take the current players card, if it has played it.
+ *
+ * @param game - Information about the game state.
+ * @return GAME_WAITING if the player has not played yet, the error 
+ *      encountered, otherwise NORMAL_EXIT.
+ */ 
+int take_turn(HubInfo* game) {
+    Turn* turn = &game->turn;
+    Player* player = &game->players[turn->current];
+    Card* played = &turn->played[turn->cardCount];
+    int status;
+
+    if (!turn->asked) {
+        if (!player->local) {
+            // Send everything the player has missed before waiting on it.
+            wake_player(game, turn->current);
+        }
+        if (game->metrics) {
+            check_metrics(game);
+        }
+        if (game->metrics || !player->local) {
+            clock_gettime(CLOCK_MONOTONIC, &turn->askedAt);
+        }
+        turn->asked = true;
+        turn->reported = false;
+    }
+
+    if (player->local) {
+        status = play_local(game, turn->current, turn->cardCount == 0, 
+                turn->lead, turn->specials, played);
+    } else if ((status = read_play(game, turn->current, played)) 
+            == GAME_WAITING) {
+        return status;
+    }
+    turn->asked = false;
+
+    if (game->metrics) {
+        PlayerMetrics* metrics = &game->metrics->players[turn->current];
+        record_value(&metrics->latency, nanos_since(&turn->askedAt));
+        metrics->messagesReceived++;
+    }
+    if (status != NORMAL_EXIT) {
+        return status;
+    } else if (game->log) {
+        log_play(game->log, *played);
+    }
+
+    // The first player is the lead.
+    if (turn->cardCount == 0) {
+        turn->lead = *played;
+    } else if (played->suit == turn->lead.suit 
+            && played->rank > turn->lead.rank) {
+        turn->lead = *played;
+        turn->winner = turn->current;
+    }
+
+    send_played(game, turn->current, *played);
+    // Track all special cards played in a round.
+    turn->specials += (played->suit == SPECIAL_SUIT);
+    turn->cardCount++;
+    turn->current = (turn->current + 1) % game->playerCount;
+    if (turn->cardCount == game->playerCount) {
+        end_round(game);
+    }
+    return NORMAL_EXIT;
+}
+
+/**
+ * Give the winner of a round what it won.
+ *
+ * @param game - Information about the game state.
+ */ 
+void end_round(HubInfo* game) {
+    Turn* turn = &game->turn;
+    Player* winner = &game->players[turn->winner];
+    winner->specialCards += turn->specials;
+    winner->score += 1;
+    game->specialsPlayed += turn->specials;
+    if (winner->local) {
+        winner->local->specialCards += turn->specials;
+        winner->local->score += 1;
+    }
+
+    if (game->report) {
+        report_round(game->report, game->games, turn->winner, turn->played, 
+                turn->cardCount);
+    }
+}
+
+/**
+ * Work out the final scores of a game and who won it.
+ *
+ * @param game - Information about the game state.
+ */ 
+void score_game(HubInfo* game) {
+    int best = 0;
+    int* scores = malloc(sizeof(int) * game->playerCount);
+    for (int i = 0; i < game->playerCount; i++) {
+        Player* competitor = &game->players[i];
+        competitor->score = final_score(competitor->score, 
+                competitor->specialCards, game->threshold);
+        competitor->totalScore += competitor->score;
+        competitor->squaredScore += competitor->score * competitor->score;
+        best = (competitor->score > game->players[best].score) ? i : best;
+        scores[i] = competitor->score;
+    }
+    if (game->report) {
+        report_scores(game->report, game->games, scores, game->playerCount);
+    }
+    free(scores);
+    if (game->log) {
+        // A game is worth finishing even if it could not be logged.
+        log_game(game->log, game->games);
+    }
+
+    // Ties share the win.
+    for (int i = 0; i < game->playerCount; i++) {
+        game->players[i].wins += 
+                (game->players[i].score == game->players[best].score);
+    }
+}
+
+/**
+ * Find the final score of a player.
+ *
+ * @param score - The rounds the player won.
+ * @param specialCards - The D cards the player won.
+ * @param threshold - The number of D cards needed for an additional score.
+ * @return The score.
+ */ 
+int final_score(int score, int specialCards, int threshold) {
+    return (specialCards < threshold) ? score - specialCards 
+            : score + specialCards;
+}
+
+/**
+ * Inform player processes that a new round has begun.
+ * 
+ * @param game - Information about the game state.
+ * @param leadPlayer - Player going first.
+ */ 
+void send_new_round(HubInfo* game, int leadPlayer) {
+    broadcast(game, &(Message) {.type = MESSAGE_NEWROUND, 
+            .player = leadPlayer}, NO_PLAYER);
+}
+
+/**
+ * Inform player processes of a played card.
+ * 
+ * @param game - Information about the game state.
+ * @param player - The player who played the card.
+ * @param played - The card that was played.
+ */ 
+void send_played(HubInfo* game, int player, Card played) {
+    broadcast(game, &(Message) {.type = MESSAGE_PLAYED, .player = player, 
+            .card = played}, player);
+}
+
+/**
+ * Queue a message for every player process. The message is formatted once 
+ * per protocol and copied to each player. Nothing is written until the 
+ * hub waits on a player, so each player gets everything queued since its 
+ * last turn in a single write. Players reading the ring share a single 
+ * copy, which includes their own cards.
+ * 
+ * @param game - Information about the game state.
+ * @param message - The message to send.
+ * @param except - A player not to send it to, or NO_PLAYER.
+ */ 
+void broadcast(HubInfo* game, const Message* message, int except) {
+    char text[CHAR_BUFFER];
+    unsigned char binary[BINARY_BUFFER];
+    int binaryLength = encode_message(message, binary);
+
+    if (game->ring) {
+        append_ring(game->ring, binary, binaryLength);
+        game->events->messages++;
+    }
+    if (!game->piped) {
+        return;
+    }
+    int textLength = format_message(message, text, CHAR_BUFFER);
+
+    for (int i = 0; i < game->playerCount; i++) {
+        Player* player = &game->players[i];
+        if (i == except || player->local || player->shared) {
+            continue;
+        } else if (player->binary) {
+            queue_bytes(&player->write, (char*) binary, binaryLength);
+        } else {
+            queue_bytes(&player->write, text, textLength);
+        }
+        game->events->messages++;
+        if (game->metrics) {
+            game->metrics->players[i].messagesSent++;
+        }
+    }
+}
+
+/**
+ * Send a player process everything queued for it, before waiting on it. 
+ * Players reading the ring are woken to read it.
+ * 
+ * @param game - Information about the game state.
+ * @param playerNum - The player to send to.
+ */ 
+void wake_player(HubInfo* game, int playerNum) {
+    Player* player = &game->players[playerNum];
+    if (player->shared && !player->mailbox) {
+        queue_encoded(&player->write, &(Message) {.type = MESSAGE_WAKE});
+    }
+    flush_channel(&player->write);
+    if (player->mailbox) {
+        signal_turn(player->mailbox);
+    }
+}
+
+/**
+ * Output the final scores of a game to stdout
+ * 
+ * @param scores - The score of each player.
+ * @param playerCount - The number of players.
+ */ 
+void output_scores(int* scores, int playerCount) {
+    for (int i = 0; i < playerCount; i++) {
+        // Control spacing of scores.
+        (i == 0) ? printf("%d:%d", i, scores[i]) : 
+                printf(" %d:%d", i, scores[i]);
+    }
+    printf("\n");
+}
+
+/**
+ * Take the card a player process has played, if it has arrived.
+ * 
+ * @param game - Information about the game state.
+ * @param currentPlayer - The player whose turn it is.
+ * @param played - Set to the card that was played.
+ * @return GAME_WAITING if the card has not arrived, the error 
+ *      encountered, otherwise NORMAL_EXIT.
+ */ 
+int read_play(HubInfo* game, int currentPlayer, Card* played) {
+    Player* player = &game->players[currentPlayer];
+    if (player->mailbox) {
+        return read_mailbox_play(game, currentPlayer, played);
+    } else if (player->binary) {
+        return read_binary_play(game, currentPlayer, played);
+    }
+    // The line belongs to the channel and needn't be freed.
+    char* line = take_line(&player->read.buffer);
+    if (!line) {
+        return player->read.closed ? ERROR_PLAYER_EOF : GAME_WAITING;
+    }
+    return parse_play(game, line, currentPlayer, played);
+}
+
+/**
+ * Read the card a player has played.
+ * 
+ * @param game - Information about the game state.
+ * @param line - A string of text.
+ * @param currentPlayer - The player whose turn it was.
+ * @param played - Set to the card that was played.
+ * @return The error encountered, otherwise NORMAL_EXIT.
+ */ 
+int parse_play(HubInfo* game, char* line, int currentPlayer, Card* played) {
+    Message message;
+    if (parse_text(line, &message) != MESSAGE_PLAY) {
+        return ERROR_PLAYER_MESSAGE;
+    }
+    *played = message.card;
+    return take_card(game, currentPlayer, *played);
+}
+
+/**
+ * Take the card a player using the binary protocol has played, if it has 
+ * arrived.
+ * 
+ * @param game - Information about the game state.
+ * @param currentPlayer - The player whose turn it is.
+ * @param played - Set to the card that was played.
+ * @return GAME_WAITING if the card has not arrived, the error 
+ *      encountered, otherwise NORMAL_EXIT.
+ */ 
+int read_binary_play(HubInfo* game, int currentPlayer, Card* played) {
+    Channel* read = &game->players[currentPlayer].read;
+    Message message;
+    unsigned char* bytes = (unsigned char*) take_bytes(&read->buffer, 
+            BINARY_PLAY_SIZE);
+
+    if (!bytes) {
+        return read->closed ? ERROR_PLAYER_EOF : GAME_WAITING;
+    } else if (decode_message(bytes, BINARY_PLAY_SIZE, &message) 
+            != BINARY_PLAY_SIZE || message.type != MESSAGE_PLAY) {
+        return ERROR_PLAYER_MESSAGE;
+    }
+    *played = message.card;
+    return take_card(game, currentPlayer, *played);
+}
+
+/**
+ * Take the card a player has put in its mailbox, if it has.
+ * 
+ * @param game - Information about the game state.
+ * @param currentPlayer - The player whose turn it is.
+ * @param played - Set to the card that was played.
+ * @return GAME_WAITING if the card has not arrived, the error 
+ *      encountered, otherwise NORMAL_EXIT.
+ */ 
+int read_mailbox_play(HubInfo* game, int currentPlayer, Card* played) {
+    Player* player = &game->players[currentPlayer];
+    uint32_t replies = __atomic_load_n(&player->mailbox->replies, 
+            __ATOMIC_ACQUIRE) - player->replies;
+
+    if (!replies) {
+        return player->read.closed ? ERROR_PLAYER_EOF : GAME_WAITING;
+    }
+    player->replies++;
+    // Only one card may be played a turn.
+    if (replies != 1 || !decode_card(player->mailbox->card, played)) {
+        return ERROR_PLAYER_MESSAGE;
+    }
+    return take_card(game, currentPlayer, *played);
+}
+
+/**
+ * Ask an in-process strategy for its card.
+ * 
+ * @param game - Information about the game state.
+ * @param currentPlayer - The player whose turn it is.
+ * @param isLead - If the player is the lead.
+ * @param lead - The first card played this round.
+ * @param specials - D cards played so far this round.
+ * @param played - Set to the card that was played.
+ * @return The error encountered, otherwise NORMAL_EXIT.
+ */ 
+int play_local(HubInfo* game, int currentPlayer, bool isLead, Card lead, 
+        int specials, Card* played) {
+    PlayerInfo* local = game->players[currentPlayer].local;
+    // Mirrors the special move a player process would work out.
+    *played = local->playCard(local, isLead, lead, 
+            specials && game->specialsPlayed >= game->threshold - 2);
+
+    remove_card(local->hand, *played);
+    local->handSize--;
+    return take_card(game, currentPlayer, *played);
+}
+
+/**
+ * Remove a played card from the hubs copy of a players hand.
+ * 
+ * @param game - Information about the game state.
+ * @param currentPlayer - The player whose turn it was.
+ * @param played - The card that was played.
+ * @return The error encountered, otherwise NORMAL_EXIT.
+ */ 
+int take_card(HubInfo* game, int currentPlayer, Card played) {
+    Player* player = &game->players[currentPlayer];
+    player->handSize--;
+    if (!remove_card(&player->held, played)) {
+        return ERROR_CARD_CHOICE;
+    }
+    return NORMAL_EXIT;
+}
+
+/**
+ * Tell a player started without arguments its seat, and the binary 
+ * protocol if it is offered, since it could not see the environment.
+ * 
+ * @param game - Information about the game state.
+ * @param playerNum - The player to seat.
+ */ 
+void send_seat(HubInfo* game, int playerNum) {
+    queue_message(&game->players[playerNum].write, "%s%d,%d,%d,%d%s\n", 
+            RECIEVE_SEAT, game->playerCount, playerNum, game->threshold, 
+            game->players[playerNum].handSize, 
+            game->binary ? "," PROTOCOL_BINARY : "");
+}
+
+/**
+ * Write a players hand to it.
+ * 
+ * @param game - Information about the game state.
+ * @param playerNum - The player to recieve its hand.
+ */ 
+void send_hand(HubInfo* game, int playerNum) {
+    Player* player = &game->players[playerNum];
+    fill_hand(&player->held, player->hand, player->handSize);
+    if (player->local) {
+        // In-process strategies get their own copy to play from.
+        *player->local->hand = player->held;
+        player->local->handSize = player->handSize;
+        player->local->score = 0;
+        player->local->specialCards = 0;
+        return;
+    }
+    if (game->metrics) {
+        game->metrics->players[playerNum].messagesSent++;
+    }
+    if (player->binary) {
+        queue_encoded(&player->write, &(Message) {.type = MESSAGE_HAND, 
+                .count = player->handSize, .cards = player->hand});
+        flush_channel(&player->write);
+        // Players with mailboxes are asleep on them.
+        if (player->mailbox) {
+            signal_turn(player->mailbox);
+        }
+        return;
+    }
+    queue_message(&player->write, "%s%d", RECIEVE_HAND, player->handSize);
+    for (int j = 0; j < player->handSize; j++) {
+        queue_message(&player->write, ",%c%c", 
+                player->hand[j].suit, player->hand[j].rank);
+    }
+    queue_message(&player->write, "\n");
+    flush_channel(&player->write);
+}
+
+/**
+ * Kill all player processes.
+ * 
+ * @param game - Information about the game state.
+ */ 
+void end_players(HubInfo* game) {
+    broadcast(game, &(Message) {.type = MESSAGE_GAMEOVER}, NO_PLAYER);
+    for (int i = 0; i < game->playerCount; i++) {
+        if (!game->players[i].local) {
+            wake_player(game, i);
+        }
+    }
+}
+
+/**
+ * Assign some cards to each player
+ * 
+ * @param game - Information about the game state.
+ * @return The error encountered, otherwise NORMAL_EXIT.
+ */ 
+int deal_cards(HubInfo* game) {
+    // The number of cards for each player to recieve. Also the # of rounds.
+    game->round = game->deckSize / game->playerCount;
+    
+    // Check that there are enough cards for each player.
+    if (game->round == 0) {
+        return ERROR_CARD_COUNT;
+    }
+
+    int offset;
+    for (int i = 0; i < game->playerCount; i++) {
+        game->players[i].hand = malloc(sizeof(Card) * game->round);
+        game->players[i].handSize = game->round;
+
+        // Assign cards from deck based on player number.
+        offset = game->round * i;
+        for (int j = offset; j < offset + game->round; j++) {
+            // Packed decks are only checked when they are packed.
+            if (!decode_card(game->deck[j], 
+                    &game->players[i].hand[j - offset])) {
+                return ERROR_DECK;
+            }
+        }
+    }
+    return NORMAL_EXIT;
+}
+
+/**
+ * Initialise a player whose strategy runs inside the hub.
+ * 
+ * @param game - Information about the game state.
+ * @param playerNum - The seat of the player.
+ * @param strategy - How to select a card from the players hand.
+ */ 
+void create_local(HubInfo* game, int playerNum, Strategy strategy) {
+    Player* player = &game->players[playerNum];
+    player->score = 0;
+    player->specialCards = 0;
+    player->totalScore = 0;
+    player->squaredScore = 0;
+    player->wins = 0;
+    player->track = -1;
+    player->binary = false;
+    player->shared = false;
+    player->mailbox = NULL;
+
+    player->local = malloc(sizeof(PlayerInfo));
+    *player->local = (PlayerInfo) {.playerCount = game->playerCount, 
+            .playerNum = playerNum, .threshold = game->threshold, 
+            .hand = malloc(sizeof(Hand)), .playCard = strategy.play, 
+            .table = strategy.table};
+}
+
+/**
+ * Write everything recorded about the players as JSON, replacing any 
+ * earlier report.
+ * 
+ * @param game - Information about the game state.
+ * @return Whether the report was written.
+ */ 
+bool write_metrics(HubInfo* game) {
+    FILE* output = fopen(game->metrics->path, "w");
+    if (!output) {
+        return false;
+    }
+    fprintf(output, "{\"games\": %d, \"elapsedNanos\": %ld, "
+            "\"messages\": %ld, \"writes\": %ld, \"players\": [", 
+            game->games, nanos_since(&game->metrics->start), 
+            game->events->messages, game->events->writes);
+
+    // Players are only reported once they have been created.
+    for (int i = 0; game->players && i < game->playerCount; i++) {
+        Player* player = &game->players[i];
+        PlayerMetrics* metrics = &game->metrics->players[i];
+        // In-process players have no pipes.
+        Channel none = {.bytes = 0, .calls = 0, .flushes = 0};
+        Channel* read = player->local ? &none : &player->read;
+        Channel* write = player->local ? &none : &player->write;
+        Channel* error = player->local ? &none : &player->error;
+
+        fprintf(output, "%s\n  {\"player\": %d, \"latencyNanos\": ", 
+                i ? "," : "", i);
+        write_histogram(output, &metrics->latency);
+        fprintf(output, ", \"messagesSent\": %ld, \"messagesReceived\": %ld"
+                ", \"bytesSent\": %ld, \"bytesReceived\": %ld, "
+                "\"errorBytes\": %ld, \"writeCalls\": %ld, "
+                "\"readCalls\": %ld, \"flushes\": %ld}", 
+                metrics->messagesSent, metrics->messagesReceived, 
+                write->bytes, read->bytes, error->bytes, write->calls, 
+                read->calls + error->calls, write->flushes);
+    }
+    fprintf(output, "\n]}\n");
+    return !fclose(output);
+}
+
+/**
+ * Write a report if SIGUSR1 has asked for one since the last check.
+ * 
+ * @param game - Information about the game state.
+ */ 
+void check_metrics(void* game) {
+    if (metricsRequested) {
+        metricsRequested = 0;
+        write_metrics(game);
+    }
+}
@@ -0,0 +1,184 @@
+#ifndef _GAME_H_
+#define _GAME_H_
+
+#include <sys/types.h> 
+#include "strategy.h"
+#include "deck.h"
+#include "events.h"
+#include "metrics.h"
+#include "gamelog.h"
+#include "report.h"
+
+#define ERROR_INCORRECT_ARGS 1
+#define ERROR_INVALID_THRESHOLD 2 
+#define ERROR_DECK 3
+#define ERROR_CARD_COUNT 4
+#define ERROR_PLAYER 5
+#define ERROR_PLAYER_EOF 6
+#define ERROR_PLAYER_MESSAGE 7
+#define ERROR_CARD_CHOICE 8
+#define ERROR_SIGHUP 9
+
+#define BINARY_PLAY_SIZE 2
+#define BINARY_BUFFER 16
+#define NO_PLAYER -1
+#define GAME_WAITING -1
+#define MAILBOX_POLL_MILLIS 5
+
+struct PlayerPool;
+
+/**
+ * Representation of a player.
+ * 
+ * @param hand - The cards dealt to the player
+ * @param held - The cards the player has not played yet
+ * @param handSize - The number of cards
+ * @param score - rounds won by the player
+ * @param specialCards - D cards won by the player
+ * @param track - The players process ID
+ * @param read - A channel to read the players messages
+ * @param write - A channel to write the player messages
+ * @param error - A channel draining the players stderr
+ * @param totalScore - Final scores summed over every game played
+ * @param squaredScore - Squares of final scores summed, for their variance
+ * @param wins - Games in which the player had the top score
+ * @param local - The state of an in-process strategy, NULL for processes
+ * @param binary - Whether the player agreed to the binary protocol
+ * @param shared - Whether the player reads broadcasts from the ring
+ * @param mailbox - Where the player takes turns, or NULL to use its pipes
+ * @param replies - The cards taken from the players mailbox
+ * @param capture - What is kept of the players stderr
+ */ 
+typedef struct {
+    Card* hand;
+    Hand held;
+    int handSize;
+    int score;
+    int specialCards;
+    pid_t track;
+    Channel read;
+    Channel write;
+    Channel error;
+    long totalScore;
+    long squaredScore;
+    int wins;
+    PlayerInfo* local;
+    bool binary;
+    bool shared;
+    Mailbox* mailbox;
+    uint32_t replies;
+    Capture capture;
+} Player;
+
+/**
+ * Where a game is up to, so that it can be put down whenever it waits on 
+ * a player and picked up again once the player has played.
+ * 
+ * @param winner - The player who led the round, then the winner so far
+ * @param current - The player whose turn it is
+ * @param cardCount - The cards played this round, the player count 
+ *      between rounds
+ * @param specials - D cards played this round
+ * @param lead - The card to beat
+ * @param played - The cards played this round
+ * @param asked - Whether the current player has been asked for its card
+ * @param askedAt - When it was asked
+ * @param reported - Whether it has been reported as slow
+ */ 
+typedef struct {
+    int winner;
+    int current;
+    int cardCount;
+    int specials;
+    Card lead;
+    Card* played;
+    bool asked;
+    struct timespec askedAt;
+    bool reported;
+} Turn;
+
+/**
+ * Stores all information pertaining to the game
+ *
+ * @param threshold - The number of D cards needed for an additional score
+ * @param playerCount - The number of players
+ * @param deckSize - The number of cards stored in the hub.
+ * @param round - The number of rounds to play
+ * @param deck - All cards in the game, one byte each as encode_card makes
+ * @param players - All the players in the game
+ * @param games - The number of games played with these players
+ * @param specialsPlayed - D cards played in earlier rounds of this game
+ * @param report - Where rounds and scores are printed, or NULL
+ * @param events - The event loop watching player processes
+ * @param binary - Whether to offer players the binary protocol
+ * @param metrics - What is recorded about each player, or NULL
+ * @param log - Where finished games are appended, or NULL
+ * @param ring - The ring broadcasts are appended to, or NULL
+ * @param piped - Player processes that are sent broadcasts through pipes
+ * @param mailboxes - Whether to offer players mailboxes in the ring
+ * @param turn - Where the game in progress is up to
+ * @param capturePath - Where player processes stderr is appended, 
+ *      followed by a dot and the player number, or NULL
+ * @param captureSize - The bytes of each players stderr to keep for 
+ *      when the game ends in an error, or 0
+ * @param pool - Player processes started ahead of the game, or NULL
+ */ 
+typedef struct {
+    int threshold;
+    int playerCount;
+    int deckSize;
+    int round;
+    unsigned char* deck;
+    Player* players;
+    int games;
+    int specialsPlayed;
+    Report* report;
+    EventLoop* events;
+    bool binary;
+    Metrics* metrics;
+    GameLog* log;
+    Ring* ring;
+    int piped;
+    bool mailboxes;
+    Turn turn;
+    const char* capturePath;
+    int captureSize;
+    struct PlayerPool* pool;
+} HubInfo;
+
+/* Game running */
+int new_game(HubInfo* game);
+int run_game(HubInfo* game);
+void start_game(HubInfo* game);
+int advance_game(HubInfo* game);
+void await_play(HubInfo* game);
+void begin_round(HubInfo* game);
+int take_turn(HubInfo* game);
+void end_round(HubInfo* game);
+void score_game(HubInfo* game);
+int deal_cards(HubInfo* game);
+void end_players(HubInfo* game);
+void create_local(HubInfo* game, int playerNum, Strategy strategy);
+int final_score(int score, int specialCards, int threshold);
+
+/* Player communication */
+void send_seat(HubInfo* game, int playerNum);
+void send_hand(HubInfo* game, int playerNum);
+void send_played(HubInfo* game, int player, Card played);
+void send_new_round(HubInfo* game, int leadPlayer);  
+void broadcast(HubInfo* game, const Message* message, int except);
+void wake_player(HubInfo* game, int playerNum);
+void output_scores(int* scores, int playerCount);
+bool write_metrics(HubInfo* game);
+void check_metrics(void* game);
+
+/* Card handling */
+int read_play(HubInfo* game, int currentPlayer, Card* played);
+int parse_play(HubInfo* game, char* line, int currentPlayer, Card* played);
+int read_binary_play(HubInfo* game, int currentPlayer, Card* played);
+int read_mailbox_play(HubInfo* game, int currentPlayer, Card* played);
+int play_local(HubInfo* game, int currentPlayer, bool isLead, Card lead, 
+        int specials, Card* played);
+int take_card(HubInfo* game, int currentPlayer, Card played);
+
+#endif // _GAME_H_
@@ -0,0 +1,188 @@
+#include "gamelog.h"
+
+/**
+ * Open a log to append games to, starting it if it is empty.
+ * 
+ * @param log - The log to open.
+ * @param path - The file to append to.
+ * @return Whether the file could be opened.
+ */ 
+bool open_log(GameLog* log, const char* path) {
+    struct stat info;
+    log->fd = open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    log->plays = NULL;
+    log->length = 0;
+    log->capacity = 0;
+    if (log->fd == -1) {
+        return false;
+    } else if (fstat(log->fd, &info) == -1) {
+        close(log->fd);
+        return false;
+    }
+    return info.st_size > 0 
+            || write(log->fd, LOG_MAGIC, LOG_MAGIC_SIZE) == LOG_MAGIC_SIZE;
+}
+
+/**
+ * Append to the same file as another log, with a buffer of its own.
+ * 
+ * @param log - The log to set up.
+ * @param shared - An open log.
+ */ 
+void share_log(GameLog* log, const GameLog* shared) {
+    *log = (GameLog) {.fd = shared->fd, .plays = NULL, .length = 0, 
+            .capacity = 0};
+}
+
+/**
+ * Free the buffer of a log. The file is left open for logs sharing it.
+ * 
+ * @param log - The log to free.
+ */ 
+void free_log(GameLog* log) {
+    free(log->plays);
+    log->plays = NULL;
+    log->capacity = 0;
+}
+
+/**
+ * Append who is playing in the games that follow.
+ * 
+ * @param log - The log to append to.
+ * @param threshold - The number of D cards needed for an additional score.
+ * @param playerCount - The number of players.
+ * @param names - The name of each player.
+ * @return Whether the record was written.
+ */ 
+bool log_seating(GameLog* log, int threshold, int playerCount, 
+        char** names) {
+    int size = 1 + 2 * MAX_VARINT;
+    for (int i = 0; i < playerCount; i++) {
+        size += MAX_VARINT + strlen(names[i]);
+    }
+    unsigned char* record = malloc(size);
+    int length = 0;
+
+    record[length++] = LOG_SEATING;
+    length += put_varint(record + length, threshold);
+    length += put_varint(record + length, playerCount);
+    for (int i = 0; i < playerCount; i++) {
+        int nameLength = strlen(names[i]);
+        length += put_varint(record + length, nameLength);
+        memcpy(record + length, names[i], nameLength);
+        length += nameLength;
+    }
+    bool written = write(log->fd, record, length) == length;
+    free(record);
+    return written;
+}
+
+/**
+ * Add a card to the game being played.
+ * 
+ * @param log - The log to add to.
+ * @param card - The card played.
+ */ 
+void log_play(GameLog* log, Card card) {
+    if (log->length == log->capacity) {
+        log->capacity = log->capacity ? log->capacity * 2 : CHAR_BUFFER;
+        log->plays = realloc(log->plays, log->capacity);
+    }
+    log->plays[log->length++] = encode_card(card);
+}
+
+/**
+ * Append the game that has just finished and start the next.
+ * 
+ * @param log - The log to append to.
+ * @param deck - The id of the deck the game was played with.
+ * @return Whether the record was written.
+ */ 
+bool log_game(GameLog* log, int deck) {
+    unsigned char header[LOG_HEADER_SIZE];
+    int length = 0;
+    header[length++] = LOG_GAME;
+    length += put_varint(header + length, deck);
+    length += put_varint(header + length, log->length);
+
+    struct iovec parts[] = {{header, length}, {log->plays, log->length}};
+    bool written = writev(log->fd, parts, 2) == length + log->length;
+    log->length = 0;
+    return written;
+}
+
+/**
+ * Read a varint that may be near the end of the log.
+ * 
+ * @param data - The log.
+ * @param length - The size of the log.
+ * @param used - The position to read from, moved past the varint.
+ * @param value - Set to the number read.
+ * @return Whether there was a valid varint.
+ */ 
+bool read_count(const unsigned char* data, long length, long* used, 
+        int* value) {
+    long left = length - *used;
+    int step = get_varint(data + *used, (left < MAX_VARINT) ? left 
+            : MAX_VARINT, value);
+    *used += (step > 0) ? step : 0;
+    return step > 0;
+}
+
+/**
+ * Read the record at the start of some bytes of a log.
+ * 
+ * @param data - The bytes following the last record read.
+ * @param length - The number of bytes left in the log.
+ * @param record - Set to the record.
+ * @return The size of the record, or 0 if it is invalid or cut short.
+ */ 
+long read_record(const unsigned char* data, long length, 
+        LogRecord* record) {
+    long used = 1;
+    if (length < 1) {
+        return 0;
+    }
+    record->type = data[0];
+
+    if (record->type == LOG_SEATING) {
+        if (!read_count(data, length, &used, &record->threshold) 
+                || !read_count(data, length, &used, &record->playerCount)) {
+            return 0;
+        }
+        record->names = data + used;
+        for (int i = 0; i < record->playerCount; i++) {
+            int nameLength;
+            if (!read_count(data, length, &used, &nameLength) 
+                    || nameLength > length - used) {
+                return 0;
+            }
+            used += nameLength;
+        }
+        return used;
+    } else if (record->type == LOG_GAME) {
+        if (!read_count(data, length, &used, &record->deck) 
+                || !read_count(data, length, &used, &record->count) 
+                || record->count > length - used) {
+            return 0;
+        }
+        record->plays = data + used;
+        return used + record->count;
+    }
+    return 0;
+}
+
+/**
+ * Read one of the names of a seating.
+ * 
+ * @param names - The name to read, from LogRecord.names or a later name.
+ * @param name - Set to the first character of the name.
+ * @param length - Set to the length of the name.
+ * @return The bytes used, to find the next name.
+ */ 
+int read_name(const unsigned char* names, const char** name, int* length) {
+    // read_record has already checked the names.
+    int used = get_varint(names, MAX_VARINT, length);
+    *name = (const char*) names + used;
+    return used + *length;
+}
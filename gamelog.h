@@ -0,0 +1,76 @@
+#ifndef _GAMELOG_H_
+#define _GAMELOG_H_
+
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <sys/stat.h>
+#include "utilities.h"
+
+#define LOG_MAGIC "2310GLOG"
+#define LOG_MAGIC_SIZE 8
+#define LOG_SEATING 1
+#define LOG_GAME 2
+#define LOG_HEADER_SIZE (1 + 2 * MAX_VARINT)
+
+/**
+ * An append-only record of games played. Each game's plays are gathered in 
+ * a buffer and appended with a single write, so logs shared between 
+ * threads or hubs never interleave within a game.
+ * 
+ * The file starts with LOG_MAGIC and is followed by records, each starting 
+ * with its type:
+ *  LOG_SEATING - threshold, player count, then each player's name as a 
+ *      length and its bytes, all as varints but the name bytes
+ *  LOG_GAME - the deck id and number of plays as varints, then one byte 
+ *      per play as encode_card makes. Who played each card is implied, 
+ *      since the winner of a round leads the next.
+ * 
+ * @param fd - The log file, opened for appending
+ * @param plays - The cards played so far in the current game
+ * @param length - The number of cards played
+ * @param capacity - The size of plays
+ */ 
+typedef struct {
+    int fd;
+    unsigned char* plays;
+    int length;
+    int capacity;
+} GameLog;
+
+/**
+ * A record read back from a log.
+ * 
+ * @param type - LOG_SEATING or LOG_GAME
+ * @param threshold - The threshold of a seating
+ * @param playerCount - The number of players of a seating
+ * @param names - The names of a seating, each a varint length and its bytes
+ * @param deck - The deck id of a game
+ * @param count - The number of plays of a game
+ * @param plays - The cards played in a game
+ */ 
+typedef struct {
+    int type;
+    int threshold;
+    int playerCount;
+    const unsigned char* names;
+    int deck;
+    int count;
+    const unsigned char* plays;
+} LogRecord;
+
+/* Writing */
+bool open_log(GameLog* log, const char* path);
+void share_log(GameLog* log, const GameLog* shared);
+void free_log(GameLog* log);
+bool log_seating(GameLog* log, int threshold, int playerCount, 
+        char** names);
+void log_play(GameLog* log, Card card);
+bool log_game(GameLog* log, int deck);
+
+/* Reading */
+bool read_count(const unsigned char* data, long length, long* used, 
+        int* value);
+long read_record(const unsigned char* data, long length, LogRecord* record);
+int read_name(const unsigned char* names, const char** name, int* length);
+
+#endif // _GAMELOG_H_
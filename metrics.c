@@ -0,0 +1,148 @@
+#include "metrics.h"
+
+volatile sig_atomic_t metricsRequested = 0;
+
+/**
+ * Find the bucket a value is recorded in. Values below two sub-buckets' 
+ * worth get a bucket each, after which every power of two gets 
+ * SUB_BUCKETS buckets.
+ * 
+ * @param value - The value to place.
+ * @return The index of its bucket.
+ */ 
+int bucket_of(uint64_t value) {
+    if (value < 2 * SUB_BUCKETS) {
+        return value;
+    }
+    int shift = 63 - __builtin_clzll(value) - SUB_BUCKET_BITS;
+    return (shift + 1) * SUB_BUCKETS + (value >> shift) - SUB_BUCKETS;
+}
+
+/**
+ * Find the smallest value recorded in a bucket.
+ * 
+ * @param bucket - The index of the bucket.
+ */ 
+uint64_t bucket_low(int bucket) {
+    if (bucket < 2 * SUB_BUCKETS) {
+        return bucket;
+    }
+    int shift = bucket / SUB_BUCKETS - 1;
+    return (uint64_t) (SUB_BUCKETS + bucket % SUB_BUCKETS) << shift;
+}
+
+/**
+ * Find the largest value recorded in a bucket.
+ * 
+ * @param bucket - The index of the bucket.
+ */ 
+uint64_t bucket_high(int bucket) {
+    return (bucket + 1 < HISTOGRAM_BUCKETS) 
+            ? bucket_low(bucket + 1) - 1 : UINT64_MAX;
+}
+
+/**
+ * Add a value to a histogram.
+ * 
+ * @param histogram - The histogram to add to.
+ * @param value - The value to add.
+ */ 
+void record_value(Histogram* histogram, uint64_t value) {
+    histogram->counts[bucket_of(value)]++;
+    if (histogram->count++ == 0 || value < histogram->min) {
+        histogram->min = value;
+    }
+    if (value > histogram->max) {
+        histogram->max = value;
+    }
+    histogram->total += value;
+}
+
+/**
+ * Find the value below which a percentage of recorded values fall, to 
+ * within the precision of a bucket.
+ * 
+ * @param histogram - The histogram to search.
+ * @param percentile - The percentage wanted, from 0 to 100.
+ * @return The highest value equivalent to the percentile, or 0 if 
+ *      nothing was recorded.
+ */ 
+uint64_t value_at_percentile(const Histogram* histogram, double percentile) {
+    uint64_t wanted = percentile / 100 * histogram->count + 0.5;
+    uint64_t seen = 0;
+    wanted = (wanted < 1) ? 1 : wanted;
+    for (int i = 0; i < HISTOGRAM_BUCKETS && histogram->count; i++) {
+        if ((seen += histogram->counts[i]) >= wanted) {
+            uint64_t high = bucket_high(i);
+            return (high < histogram->max) ? high : histogram->max;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Write a histogram as a JSON object of its summary and every bucket that 
+ * holds a value.
+ * 
+ * @param output - Where to write.
+ * @param histogram - The histogram to write.
+ */ 
+void write_histogram(FILE* output, const Histogram* histogram) {
+    const double percentiles[] = {50, 90, 99, 99.9};
+    const char* names[] = {"p50", "p90", "p99", "p999"};
+
+    fprintf(output, "{\"count\": %lu, \"min\": %lu, \"max\": %lu, "
+            "\"mean\": %.1f", histogram->count, histogram->min, 
+            histogram->max, histogram->count 
+            ? (double) histogram->total / histogram->count : 0.0);
+    for (int i = 0; i < sizeof(percentiles) / sizeof(percentiles[0]); i++) {
+        fprintf(output, ", \"%s\": %lu", names[i], 
+                value_at_percentile(histogram, percentiles[i]));
+    }
+    fprintf(output, ", \"buckets\": [");
+    bool first = true;
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        if (histogram->counts[i]) {
+            fprintf(output, "%s[%lu, %lu]", first ? "" : ", ", 
+                    bucket_low(i), histogram->counts[i]);
+            first = false;
+        }
+    }
+    fprintf(output, "]}");
+}
+
+/**
+ * Start recording metrics for a run.
+ * 
+ * @param metrics - The metrics to initialise.
+ * @param path - The file to write the report to.
+ * @param playerCount - The number of players.
+ */ 
+void init_metrics(Metrics* metrics, const char* path, int playerCount) {
+    metrics->path = path;
+    metrics->players = calloc(playerCount, sizeof(PlayerMetrics));
+    clock_gettime(CLOCK_MONOTONIC, &metrics->start);
+}
+
+/**
+ * Find how long ago something happened.
+ * 
+ * @param start - When it happened.
+ * @return The nanoseconds since.
+ */ 
+long nanos_since(const struct timespec* start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000000000L 
+            + now.tv_nsec - start->tv_nsec;
+}
+
+/**
+ * Signal handler asking for a report. It is written once the hub is 
+ * somewhere safe to do so.
+ * 
+ * @param sig - The signal recieved.
+ */ 
+void request_metrics(int sig) {
+    metricsRequested = 1;
+}
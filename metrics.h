@@ -0,0 +1,74 @@
+#ifndef _METRICS_H_
+#define _METRICS_H_
+
+#include <signal.h>
+#include <time.h>
+#include "utilities.h"
+
+#define SUB_BUCKET_BITS 4
+#define SUB_BUCKETS (1 << SUB_BUCKET_BITS)
+#define HISTOGRAM_BUCKETS ((64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS)
+
+/**
+ * A histogram of nanosecond values in the style of HdrHistogram. Each 
+ * power of two is split into SUB_BUCKETS equal buckets, so any value is 
+ * recorded in constant time to within 1 / SUB_BUCKETS of itself.
+ * 
+ * @param counts - How many values fell in each bucket
+ * @param count - How many values were recorded
+ * @param total - The sum of every value
+ * @param min - The smallest value, exactly
+ * @param max - The largest value, exactly
+ */ 
+typedef struct {
+    uint64_t counts[HISTOGRAM_BUCKETS];
+    uint64_t count;
+    uint64_t total;
+    uint64_t min;
+    uint64_t max;
+} Histogram;
+
+/**
+ * What the hub saw of one player.
+ * 
+ * @param latency - Nanoseconds from the hub flushing everything the player 
+ *      needed to its reply arriving
+ * @param messagesSent - Messages queued to the player
+ * @param messagesReceived - Plays read from the player
+ */ 
+typedef struct {
+    Histogram latency;
+    long messagesSent;
+    long messagesReceived;
+} PlayerMetrics;
+
+/**
+ * The metrics of a hub run and where to write them.
+ * 
+ * @param path - The file the JSON report is written to
+ * @param players - The metrics of each player
+ * @param start - When the run began
+ */ 
+typedef struct {
+    const char* path;
+    PlayerMetrics* players;
+    struct timespec start;
+} Metrics;
+
+/* Set whenever SIGUSR1 asks for a report. */
+extern volatile sig_atomic_t metricsRequested;
+
+/* Histograms */
+int bucket_of(uint64_t value);
+uint64_t bucket_low(int bucket);
+uint64_t bucket_high(int bucket);
+void record_value(Histogram* histogram, uint64_t value);
+uint64_t value_at_percentile(const Histogram* histogram, double percentile);
+void write_histogram(FILE* output, const Histogram* histogram);
+
+/* Metrics */
+void init_metrics(Metrics* metrics, const char* path, int playerCount);
+long nanos_since(const struct timespec* start);
+void request_metrics(int sig);
+
+#endif // _METRICS_H_
@@ -1,5 +1,8 @@
 #include "player.h"
 
+PlayerLog playerLog = {.level = LOG_ROUND, .eager = false, 
+        .text = {.fd = STDERR_FILENO}, .trace = {.fd = -1}};
+
 /**
  * Set up the players
  * 
@@ -9,19 +12,40 @@
  */ 
 void init_game(Card (*playCard)(struct PlayerInfo*, bool, Card, bool), 
         int argv, char** argc) {
-    if (argv != 5) {
+    start_logging();
+    // Players joining a server, or started into a hubs pool, are given 
+    // their seat by it instead.
+    char* server = getenv(SERVER_VARIABLE);
+    bool pooled = getenv(POOL_VARIABLE);
+    if (argv != 5 && !(argv == 1 && (server || pooled))) {
         exit_game(ERROR_INCORRECT_ARGS);
-    } 
-    PlayerInfo game;
+    } else if (argv == 1 && pooled) {
+        printf("%c", PLAYER_WAITING);
+        fflush(stdout);
+    } else if (argv == 1) {
+        connect_server(server);
+    }
+    Ring ring;
+    PlayerInfo game = {.score = 0, .specialCards = 0, .binary = false, 
+            .hand = malloc(sizeof(Hand)), .ring = &ring, .mailbox = NULL};
     game.playCard = playCard;
+    init_reader(&game.input, STDIN_FILENO);
 
-    affirm_input(&game, argc);
+    if (argv == 1) {
+        read_seat(&game);
+    } else {
+        affirm_input(&game, argc);
+    }
+    log_seat(&game);
 
+    // The first hand is always text, even if binary was agreed on.
     read_hand(&game);
-    
+    game.binary = binary_requested() || game.ring;
+
     run_round(&game);
 
     free(game.hand);
+    free_reader(&game.input);
     exit(NORMAL_EXIT);
 }
 
@@ -31,20 +55,46 @@ void init_game(Card (*playCard)(struct PlayerInfo*, bool, Card, bool),
  * @param game - information about that game.
  */ 
 void run_round(PlayerInfo* game) {
-    char* line;
-    int leadPlayer = 0;
+    Message message;
     int wonOnD = 0;
-    while (read_new_line(stdin, &line)) {
-        if (game->handSize == 0 || check_command(line, RECIEVE_NEWROUND, false)
-                || (leadPlayer = read_int(strtok(line, RECIEVE_NEWROUND))) < 0 
-                || leadPlayer >= game->playerCount) {
+    while (true) {
+        next_message(game, &message);
+        // A tournament hub reuses players across games.
+        if (message.type == MESSAGE_NEWGAME) {
+            new_game(game, message.count);
+            wonOnD = 0;
+            continue;
+        }
+        if (game->handSize == 0 || message.type != MESSAGE_NEWROUND 
+                || message.player < 0 
+                || message.player >= game->playerCount) {
             exit_game(ERROR_INVALID_MESSAGE);
         }
-        free(line);
-        watch_round(game, leadPlayer, &wonOnD);
+        watch_round(game, message.player, &wonOnD);
+        if (game->handSize == 0) {
+            log_game(game);
+        }
     }
 }
 
+/**
+ * Reset the game state and read the next hand.
+ * 
+ * @param game - Information about the game state.
+ * @param handSize - The size of the next hand.
+ */ 
+void new_game(PlayerInfo* game, int handSize) {
+    // The previous hand must have been played out.
+    if (game->handSize != 0 || handSize < 1) {
+        exit_game(ERROR_INVALID_MESSAGE);
+    }
+    game->handSize = handSize;
+
+    game->score = 0;
+    game->specialCards = 0;
+    read_hand(game);
+}
+
 /**
  * Handle a round of the game.
  * 
@@ -54,7 +104,7 @@ void run_round(PlayerInfo* game) {
  */ 
 void watch_round(PlayerInfo* game, int leadPlayer, int* wonOnD) {
     int currentPlayer = leadPlayer;
-    char* line;
+    Message message;
     int winner = leadPlayer;
     int cardCount = 0;
     Card* playedCard = malloc(sizeof(Card) * game->playerCount);
@@ -64,13 +114,21 @@ void watch_round(PlayerInfo* game, int leadPlayer, int* wonOnD) {
     do {
         // Check who's turn it is and either play a card or read it.
         if (currentPlayer == game->playerNum) {
-            playedCard[cardCount] = game->playCard(game, 
+            // The hub may end the player as soon as it has every card, 
+            // so the game so far is logged before the last is sent.
+            if (game->handSize == 1) {
+                flush_logs();
+            }
+            playedCard[cardCount] = make_move(game, 
                     (leadPlayer == currentPlayer), playedCard[0], 
                     (seenD && *wonOnD >= game->threshold - 2));
         } else {
-            read_new_line(stdin, &line);
-            playedCard[cardCount] = parse_play(line, currentPlayer);
-            free(line);
+            next_message(game, &message);
+            if (message.type != MESSAGE_PLAYED 
+                    || message.player != currentPlayer) {
+                exit_game(ERROR_INVALID_MESSAGE);
+            }
+            playedCard[cardCount] = message.card;
         }
 
         // Update the winner
@@ -78,7 +136,7 @@ void watch_round(PlayerInfo* game, int leadPlayer, int* wonOnD) {
                 && playedCard[cardCount].rank > playedCard[0].rank) {
             winner = currentPlayer;
         }
-        
+
         // Track all D cards played.
         seenD += (playedCard[cardCount++].suit == SPECIAL_SUIT);
         currentPlayer = (currentPlayer + 1) % game->playerCount;
@@ -88,84 +146,181 @@ void watch_round(PlayerInfo* game, int leadPlayer, int* wonOnD) {
         game->score++;
         game->specialCards += seenD;
     }
-    
-    fprintf(stderr, "Lead player=%d:", leadPlayer);
-    for (int i = 0; i < cardCount; i++) {
-        (*wonOnD) += (playedCard[i].suit == SPECIAL_SUIT);
-        fprintf(stderr, " %c.%c", playedCard[i].suit, playedCard[i].rank);
-    }
-    fprintf(stderr, "\n");
+    (*wonOnD) += seenD;
 
+    // Nothing is formatted unless it is logged.
+    if (playerLog.level == LOG_ROUND || playerLog.trace.fd != -1) {
+        log_round(leadPlayer, playedCard, cardCount);
+    }
     free(playedCard);
 }
 
 /**
- * Read a card from the hub.
+ * Choose a card with the players strategy and send it to the hub.
  * 
- * @param line - A string.
- * @param expectedPlayer - the player whose turn it is 
+ * @param game - Information about the game state.
+ * @param isLead - If the player is the lead.
+ * @param lead - The first card played this round.
+ * @param specialMove - Does the player have a special move.
+ * @return The card that was played.
  */ 
-Card parse_play(char* line, int expectedPlayer) { 
-    char* newCard;
+Card make_move(PlayerInfo* game, bool isLead, Card lead, bool specialMove) {
+    Card toPlay = game->playCard(game, isLead, lead, specialMove);
 
-    // Check the command, player and card recieved from the hub is correct.
-    if (check_command(line, RECIEVE_PLAYED, false) || read_int(strtok(
-            line + strlen(RECIEVE_PLAYED), ",")) != expectedPlayer 
-            || (newCard = strtok(NULL, ",")) == NULL || !check_card(newCard)) {
-        exit_game(ERROR_INVALID_MESSAGE);
-    } 
-    return (Card) {.suit = newCard[0], .rank = newCard[1]};
+    remove_card(game->hand, toPlay);
+    game->handSize--;
+
+    // Send the card to the game
+    if (game->mailbox) {
+        post_reply(game->mailbox, encode_card(toPlay));
+        return toPlay;
+    } else if (game->binary) {
+        unsigned char play[] = {MESSAGE_PLAY, encode_card(toPlay)};
+        fwrite(play, sizeof(play), 1, stdout);
+    } else {
+        printf("%s%c%c\n", SEND_PLAY, toPlay.suit, toPlay.rank);
+    }
+    if (fflush(stdout) == EOF) {
+        exit_game(ERROR_UNEXPECTED_EOF);
+    }
+
+    return toPlay;
 }
 
 /**
- * Read in a hand.
+ * Read the next message from the hub in whichever protocol is in use. 
+ * Invalid messages, GAMEOVER and EOF all end the player.
  * 
- * @param game - Information about the game state
+ * @param game - Information about the game state.
+ * @param message - Set to the message read.
  */ 
-void read_hand(PlayerInfo* game) {
-    char* line;
-    read_new_line(stdin, &line);
-
-    if (check_command(line, RECIEVE_HAND, false)) {
-        exit_game(ERROR_INVALID_MESSAGE);
+void next_message(PlayerInfo* game, Message* message) {
+    if (game->ring) {
+        read_shared(game, message);
+    } else if (game->binary) {
+        read_binary(game, message);
+    } else {
+        parse_message(game, read_new_line(&game->input), message);
     }
-    parse_hand(line, &game->hand, game->handSize);
-    free(line);
 }
 
 /**
- * Read a hand from the player.
+ * Interpret a line of text from the hub.
  * 
+ * @param game - Information about the game state.
  * @param line - A string of text.
- * @param hand - An array of Cards.
- * @param handSize - The size of the hand.
+ * @param message - Set to the message the line holds.
  */ 
-void parse_hand(char* line, Card** hand, int handSize) {
-    int tempCount = 0;
-    int cardCount = read_int(strtok(line + strlen(RECIEVE_HAND), ","));
-
-    if (cardCount < 1 || cardCount != handSize) {
-        exit_game(ERROR_INVALID_MESSAGE);
+void parse_message(PlayerInfo* game, char* line, Message* message) {
+    switch (parse_text(line, message)) {
+        case MESSAGE_NEWGAME:
+        case MESSAGE_NEWROUND:
+        case MESSAGE_PLAYED:
+            return;
+        case MESSAGE_HAND:
+            if (message->count == game->handSize) {
+                return;
+            }
+            free(message->cards);
+            break;
+        default:
+            break;
     }
+    exit_game(ERROR_INVALID_MESSAGE);
+}
 
-    (*hand) = malloc(sizeof(Card) * cardCount);
+/**
+ * Read a message in the binary protocol from stdin. Any WAKE messages 
+ * before it are skipped.
+ * 
+ * @param game - Information about the game state.
+ * @param message - Set to the message read.
+ */ 
+void read_binary(PlayerInfo* game, Message* message) {
+    LineReader* input = &game->input;
+    int used;
+
+    // Decode what is buffered, reading more until a whole message is there.
+    do {
+        while ((used = decode_message((unsigned char*) input->data 
+                + input->start, input->length, message)) == 0) {
+            if (input->eof || (fill_reader(input) < 0 && errno != EINTR)) {
+                exit_game(ERROR_UNEXPECTED_EOF);
+            }
+        }
+        if (used < 0) {
+            exit_game(ERROR_INVALID_MESSAGE);
+        } else if (message->type == MESSAGE_GAMEOVER) {
+            exit_game(NORMAL_EXIT);
+        }
+        take_bytes(input, used);
+    } while (message->type == MESSAGE_WAKE);
+}
 
-    char* currentCard;
-    // Split the input by comma and fill the players hand.
-    while ((currentCard = strtok(NULL, ",")) != NULL) {
-        // Prevent oversize.
-        if (tempCount == cardCount 
-                || !check_card(currentCard)) {
+/**
+ * Read the next broadcast from the ring, skipping the players own cards. 
+ * When the ring is empty the player sleeps on its mailbox, or on stdin 
+ * until the hub sends WAKE, so it only wakes when it is its turn or the 
+ * game is over.
+ * 
+ * @param game - Information about the game state.
+ * @param message - Set to the message read.
+ */ 
+void read_shared(PlayerInfo* game, Message* message) {
+    LineReader* input = &game->input;
+    Mailbox* mailbox = game->mailbox;
+
+    while (true) {
+        // Turns are counted first, so a turn given once the ring has been 
+        // found empty isn't slept through.
+        uint32_t turns = mailbox 
+                ? __atomic_load_n(&mailbox->turns, __ATOMIC_ACQUIRE) : 0;
+        int used = read_ring(game->ring, message);
+        if (used < 0) {
             exit_game(ERROR_INVALID_MESSAGE);
+        } else if (used == 0 && mailbox) {
+            await_turn(game->ring, mailbox, turns);
+        } else if (used == 0) {
+            // The hub adds to the ring before sending anything else, so 
+            // only WAKEs can be waiting while it is empty.
+            while (input->length && input->data[input->start] 
+                    == MESSAGE_WAKE) {
+                take_bytes(input, 1);
+            }
+            if (input->length) {
+                exit_game(ERROR_INVALID_MESSAGE);
+            } else if (input->eof 
+                    || (fill_reader(input) < 0 && errno != EINTR)) {
+                exit_game(ERROR_UNEXPECTED_EOF);
+            }
+        } else if (message->type == MESSAGE_GAMEOVER) {
+            exit_game(NORMAL_EXIT);
+        } else if (message->type != MESSAGE_PLAYED 
+                || message->player != game->playerNum) {
+            return;
         }
+    }
+}
 
-        (*hand)[tempCount++] = (Card) {.suit = currentCard[0], 
-                .rank = currentCard[1]};
+/**
+ * Read in a hand.
+ * 
+ * @param game - Information about the game state
+ */ 
+void read_hand(PlayerInfo* game) {
+    Message message;
+    // Hands are never broadcast.
+    if (game->binary) {
+        read_binary(game, &message);
+    } else {
+        parse_message(game, read_new_line(&game->input), &message);
     }
-    // prevent undersize.
-    if (tempCount < cardCount - 1) {
+
+    if (message.type != MESSAGE_HAND || message.count != game->handSize) {
         exit_game(ERROR_INVALID_MESSAGE);
     }
+    fill_hand(game->hand, message.cards, message.count);
+    free(message.cards);
 }
 
 /**
@@ -175,87 +330,301 @@ void parse_hand(char* line, Card** hand, int handSize) {
  * @param argc - The command line arguments.
  */ 
 void affirm_input(PlayerInfo* game, char** argc) {
-    // Since read int returns -1 for NAN, these cases also check for it.
-    if ((game->playerCount = read_int(argc[1])) < 2) {
+    // Since read int returns -1 for NAN, the checks also catch it.
+    game->playerCount = read_int(argc[1]);
+    game->playerNum = read_int(argc[2]);
+    game->threshold = read_int(argc[3]);
+    game->handSize = read_int(argc[4]);
+    affirm_seat(game);
+}
+
+/**
+ * Check the seat the player has been given, then tell the hub it is ready.
+ * 
+ * @param game - Information about the game state, with its seat set.
+ */ 
+void affirm_seat(PlayerInfo* game) {
+    if (game->playerCount < 2) {
         exit_game(ERROR_BAD_PLAYERS);
 
-    } else if ((game->playerNum = read_int(argc[2])) >= game->playerCount 
+    } else if (game->playerNum >= game->playerCount 
             || game->playerNum < 0) {
         exit_game(ERROR_INVALID_POS);
 
-    } else if ((game->threshold = read_int(argc[3])) < 2) {
+    } else if (game->threshold < 2) {
         exit_game(ERROR_BAD_THRESHOLD);
 
-    } else if ((game->handSize = read_int(argc[4])) < 1) { 
+    } else if (game->handSize < 1) {
         exit_game(ERROR_BAD_HSIZE);
 
     }
-    printf("@"); // Successfully, read the cArgs.
+    // Successfully, read the cArgs.
+    open_shared(game);
+    printf("%c", game->mailbox ? PLAYER_READY_MAILBOX 
+            : game->ring ? PLAYER_READY_RING 
+            : binary_requested() ? PLAYER_READY_BINARY : PLAYER_READY);
     fflush(stdout);
 }
 
+/**
+ * Connect to a server in place of stdin and stdout.
+ * 
+ * @param path - The servers socket.
+ */ 
+void connect_server(const char* path) {
+    struct sockaddr_un address = {.sun_family = AF_UNIX};
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        exit_game(ERROR_INCORRECT_ARGS);
+    }
+    strcpy(address.sun_path, path);
+
+    int server = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server == -1 || connect(server, (struct sockaddr*) &address, 
+            sizeof(address)) || dup2(server, STDIN_FILENO) == -1 
+            || dup2(server, STDOUT_FILENO) == -1) {
+        exit_game(ERROR_INCORRECT_ARGS);
+    }
+    close(server);
+}
+
+/**
+ * Read the seat a server has given the player, which holds what the 
+ * command line arguments would, and the protocol it offers, if any.
+ * 
+ * @param game - Information about the game state.
+ */ 
+void read_seat(PlayerInfo* game) {
+    Message message;
+    if (parse_text(read_new_line(&game->input), &message) != MESSAGE_SEAT) {
+        exit_game(ERROR_INVALID_MESSAGE);
+    } else if (message.protocol) {
+        setenv(PROTOCOL_VARIABLE, message.protocol, true);
+    } else {
+        unsetenv(PROTOCOL_VARIABLE);
+    }
+    game->playerCount = message.players;
+    game->playerNum = message.player;
+    game->threshold = message.threshold;
+    game->handSize = message.count;
+    affirm_seat(game);
+}
+
+/**
+ * Map the ring, and the players mailbox in it, if the hub offers them.
+ * 
+ * @param game - Information about the game state, where ring has space 
+ *      for the ring. It is set to NULL if there is none.
+ */ 
+void open_shared(PlayerInfo* game) {
+    char* protocol = getenv(PROTOCOL_VARIABLE);
+    char* fd = getenv(RING_VARIABLE);
+    bool mailbox = protocol && !strcmp(protocol, PROTOCOL_MAILBOX);
+
+    if (!fd || !(mailbox || (protocol && !strcmp(protocol, PROTOCOL_RING))) 
+            || !attach_ring(game->ring, fd)) {
+        game->ring = NULL;
+    } else if (mailbox) {
+        game->mailbox = mailbox_of(game->ring, game->playerNum);
+    }
+}
+
+/**
+ * Check whether the hub has offered the binary protocol.
+ */ 
+bool binary_requested(void) {
+    char* protocol = getenv(PROTOCOL_VARIABLE);
+    return protocol && !strcmp(protocol, PROTOCOL_BINARY);
+}
+
 /* Exits the game with specifid error Code
- *
+ * 
  * @param exitCode - what to exit with
- */
+ */ 
 int exit_game(int exitCondition) {
-    const char* messages[] = {"",
-            "Usage: player players myid threshold handsize\n",
-            "Invalid players\n",
-            "Invalid position\n",
-            "Invalid threshold\n",
-            "Invalid hand size\n",
-            "Invalid message\n",
-            "EOF\n"};   
+    const char* messages[] = {"", 
+            "Usage: player players myid threshold handsize\n", 
+            "Invalid players\n", 
+            "Invalid position\n", 
+            "Invalid threshold\n", 
+            "Invalid hand size\n", 
+            "Invalid message\n", 
+            "EOF\n"};
+    flush_logs();
     fputs(messages[exitCondition], stderr);
     exit(exitCondition);
 }
 
 /**
- * Intermediary between read_line and the player.
+ * Choose what to log from the environment.
+ */ 
+void start_logging(void) {
+    const char* levels[] = {"off", "summary", "round"};
+    char* level = getenv(LOG_VARIABLE);
+    char* trace = getenv(TRACE_VARIABLE);
+
+    playerLog.eager = isatty(STDERR_FILENO);
+    for (int i = 0; level && i < sizeof(levels) / sizeof(levels[0]); i++) {
+        if (!strcmp(level, levels[i])) {
+            playerLog.level = i;
+        }
+    }
+    if (trace && *trace) {
+        // Every player is given the same path.
+        char* path = malloc(strlen(trace) + CHAR_BUFFER);
+        sprintf(path, "%s.%d", trace, getpid());
+        playerLog.trace.fd = open(path, 
+                O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        free(path);
+    }
+    if (playerLog.trace.fd != -1) {
+        memcpy(reserve_sink(&playerLog.trace, TRACE_MAGIC_SIZE), 
+                TRACE_MAGIC, TRACE_MAGIC_SIZE);
+        playerLog.trace.length += TRACE_MAGIC_SIZE;
+    }
+}
+
+/**
+ * Make room at the end of a log sink.
  * 
- * @param line - A string of text.
- * @param toRead - The file to read from.
+ * @param sink - The sink to add to.
+ * @param size - The most bytes that will be added.
+ * @return Where to add them. The caller adds what it used to the length.
  */ 
-char* read_new_line(FILE* toRead, char** line) {
-    char* lineCheck = read_line(toRead, line);
+unsigned char* reserve_sink(LogSink* sink, int size) {
+    if (sink->length + size > sink->capacity) {
+        sink->capacity = (sink->length + size) * 2;
+        sink->data = realloc(sink->data, sink->capacity);
+    }
+    return sink->data + sink->length;
+}
 
-    // Handle events that can happen anytime.
-    if (lineCheck == NULL) {
-        exit_game(ERROR_UNEXPECTED_EOF);
-    } else if (!strcmp(lineCheck, RECIEVE_GAMEOVER)) {
-        exit_game(NORMAL_EXIT);
+/**
+ * Write out everything waiting in a log sink.
+ * 
+ * @param sink - The sink to flush.
+ */ 
+void flush_sink(LogSink* sink) {
+    int written = 0;
+    while (sink->fd != -1 && written < sink->length) {
+        ssize_t bytes = write(sink->fd, sink->data + written, 
+                sink->length - written);
+        if (bytes == -1 && errno != EINTR) {
+            // A log that cannot be written is not worth ending over.
+            break;
+        }
+        written += (bytes > 0) ? bytes : 0;
     }
-    return lineCheck;
+    sink->length = 0;
+}
+
+/**
+ * Write out both logs.
+ */ 
+void flush_logs(void) {
+    flush_sink(&playerLog.text);
+    flush_sink(&playerLog.trace);
 }
 
 /**
- * Find the largest card in a hand given an order.
+ * Trace where the player has been seated.
  * 
- * @param hand - An array of cards.
- * @param handSize - The number of cards in the hand.
- * @param compRank - A function to compare two cards.
- * @param order - A specific order of cards to follow.
+ * @param game - Information about the game state.
  */ 
-Card find_extremum(Card* hand, int handSize, 
-        int (*compRank)(int, int), char* order) {
-    Card extremum = (Card) {.suit = DORMANT_CHAR, .rank = DORMANT_CHAR};
-    for (int i = 0; i < SUIT_COUNT; i++) {
-        for (int j = 0; j < handSize; j++) {
-            if (order[i] == hand[j].suit) {
-                if (extremum.suit == DORMANT_CHAR) {
-                    extremum = hand[j];
-                } else {
-                    extremum = (compRank(hand[j].rank, extremum.rank)) 
-                            ? hand[j] : extremum;
-                }
-            }
+void log_seat(PlayerInfo* game) {
+    if (playerLog.trace.fd == -1) {
+        return;
+    }
+    unsigned char* record = reserve_sink(&playerLog.trace, 
+            1 + 4 * MAX_VARINT);
+    int length = 0;
+    record[length++] = TRACE_SEAT;
+    length += put_varint(record + length, game->playerCount);
+    length += put_varint(record + length, game->playerNum);
+    length += put_varint(record + length, game->threshold);
+    length += put_varint(record + length, game->handSize);
+    playerLog.trace.length += length;
+}
+
+/**
+ * Log the cards played in a round.
+ * 
+ * @param leadPlayer - The player who went first.
+ * @param played - The cards played, starting with the lead.
+ * @param cardCount - The number of cards.
+ */ 
+void log_round(int leadPlayer, Card* played, int cardCount) {
+    if (playerLog.level == LOG_ROUND) {
+        // The line is built up at once, since large tables play thousands 
+        // of cards a round.
+        LogSink* text = &playerLog.text;
+        char* line = (char*) reserve_sink(text, 
+                CHAR_BUFFER + ROUND_CARD_LENGTH * cardCount);
+        int length = sprintf(line, "Lead player=%d:", leadPlayer);
+        for (int i = 0; i < cardCount; i++) {
+            line[length++] = ' ';
+            line[length++] = played[i].suit;
+            line[length++] = '.';
+            line[length++] = played[i].rank;
         }
-        // If a card is found, exit the loop.
-        if (extremum.suit != DORMANT_CHAR) {
-            break;
+        line[length++] = '\n';
+        text->length += length;
+        if (playerLog.eager) {
+            flush_sink(text);
+        }
+    }
+
+    if (playerLog.trace.fd != -1) {
+        unsigned char* record = reserve_sink(&playerLog.trace, 
+                1 + 2 * MAX_VARINT + cardCount);
+        int length = 0;
+        record[length++] = TRACE_ROUND;
+        length += put_varint(record + length, leadPlayer);
+        length += put_varint(record + length, cardCount);
+        for (int i = 0; i < cardCount; i++) {
+            record[length++] = encode_card(played[i]);
         }
+        playerLog.trace.length += length;
     }
-    return extremum;
 }
 
+/**
+ * Log how a game went once its last round is over, and write out 
+ * everything logged during it.
+ * 
+ * @param game - Information about the game state.
+ */ 
+void log_game(PlayerInfo* game) {
+    if (playerLog.level == LOG_SUMMARY) {
+        LogSink* text = &playerLog.text;
+        text->length += sprintf((char*) reserve_sink(text, CHAR_BUFFER), 
+                "Score=%d D cards=%d\n", game->score, game->specialCards);
+    }
+    if (playerLog.trace.fd != -1) {
+        unsigned char* record = reserve_sink(&playerLog.trace, 
+                1 + 2 * MAX_VARINT);
+        int length = 0;
+        record[length++] = TRACE_GAME;
+        length += put_varint(record + length, game->score);
+        length += put_varint(record + length, game->specialCards);
+        playerLog.trace.length += length;
+    }
+    flush_logs();
+}
+
+/**
+ * Intermediary between next_line and the player.
+ * 
+ * @param reader - The hub input to read from.
+ * @return The line, valid until the next read.
+ */ 
+char* read_new_line(LineReader* reader) {
+    char* lineCheck = next_line(reader);
+
+    // Handle events that can happen anytime.
+    if (lineCheck == NULL) {
+        exit_game(ERROR_UNEXPECTED_EOF);
+    } else if (!strcmp(lineCheck, RECIEVE_GAMEOVER)) {
+        exit_game(NORMAL_EXIT);
+    }
+    return lineCheck;
+}
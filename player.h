@@ -1,64 +1,116 @@
 #ifndef _PLAYER_H_
 #define _PLAYER_H_
 
-#include "utilities.h"
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <fcntl.h>
+#include "strategy.h"
 
 #define NORMAL_EXIT 0
 #define ERROR_INCORRECT_ARGS 1
-#define ERROR_BAD_PLAYERS 2 
+#define ERROR_BAD_PLAYERS 2
 #define ERROR_INVALID_POS 3
 #define ERROR_BAD_THRESHOLD 4
 #define ERROR_BAD_HSIZE 5
 #define ERROR_INVALID_MESSAGE 6
-#define ERROR_UNEXPECTED_EOF 7 
+#define ERROR_UNEXPECTED_EOF 7
 
-#define DORMANT_CHAR '!'
+#define ROUND_CARD_LENGTH 4
 
-#define SUIT_COUNT 4
+#define LOG_VARIABLE "HUB_PLAYER_LOG"
+#define TRACE_VARIABLE "HUB_PLAYER_TRACE"
+#define LOG_OFF 0
+#define LOG_SUMMARY 1
+#define LOG_ROUND 2
+
+#define TRACE_MAGIC "2310PTRC"
+#define TRACE_MAGIC_SIZE 8
+#define TRACE_SEAT 1
+#define TRACE_ROUND 2
+#define TRACE_GAME 3
+
+/**
+ * Bytes waiting to be written to a log, so that logging a game takes one 
+ * write instead of one per round.
+ * 
+ * @param fd - Where the bytes are written, or -1 if nothing is logged
+ * @param data - The bytes waiting
+ * @param length - The number of bytes waiting
+ * @param capacity - The size of data
+ */ 
+typedef struct {
+    int fd;
+    unsigned char* data;
+    int length;
+    int capacity;
+} LogSink;
 
 /**
- * Representation of a player.
+ * What a player logs, chosen by environment variables since the command 
+ * line is fixed. LOG_VARIABLE is one of:
+ *  off - nothing 
+ *  summary - a line to stderr for each game, with the players score 
+ *  round - a line to stderr for each round, with its lead and cards. 
+ *      This is the default. 
+ * If TRACE_VARIABLE is set, the player also writes a binary trace to that 
+ * path followed by a dot and its process ID. The trace starts with 
+ * TRACE_MAGIC and is followed by records, each starting with its type:
+ *  TRACE_SEAT - player count, player number, threshold and hand size 
+ *  TRACE_ROUND - the lead player and card count, then one byte per card 
+ *      as encode_card makes 
+ *  TRACE_GAME - the rounds and D cards the player won 
+ * where every number is a varint.
  * 
- * @param hand - An array of cards
- * @param handSize - The number of cards
- * @param score - rounds won by the player
- * @param specialCards - D cards won by the player
- * @param playerCount - The number of players
- * @param threshold - The number of D cards needed for an additional score
- * @param playCard - A function to select a card from the players hand
+ * @param level - LOG_OFF, LOG_SUMMARY or LOG_ROUND
+ * @param eager - Whether to write text every round, for a person watching
+ * @param text - Lines for stderr
+ * @param trace - Records for the trace
  */ 
-typedef struct PlayerInfo {
-    int score;
-    int specialCards;
-    int playerCount;
-    int playerNum;
-    int threshold;
-    int handSize;
-    Card* hand;
-    Card (*playCard)(struct PlayerInfo*, bool, Card, bool);
-} PlayerInfo;
+typedef struct {
+    int level;
+    bool eager;
+    LogSink text;
+    LogSink trace;
+} PlayerLog;
 
+/* Read by exit_game, so nothing buffered is lost however the player ends. */
+extern PlayerLog playerLog;
 
 /* IO functions */
 // Command Line Parsing
 void affirm_input(PlayerInfo* game, char** argc);
+void affirm_seat(PlayerInfo* game);
+void connect_server(const char* path);
+void read_seat(PlayerInfo* game);
 // Card Reading
 void read_hand(PlayerInfo* game);
-void parse_hand(char* line, Card** hand, int handSize);
-// Play reading
-Card parse_play(char* line, int expectedPlayer);
+// Message reading
+void next_message(PlayerInfo* game, Message* message);
+void parse_message(PlayerInfo* game, char* line, Message* message);
+void read_binary(PlayerInfo* game, Message* message);
+void read_shared(PlayerInfo* game, Message* message);
+bool binary_requested(void);
+void open_shared(PlayerInfo* game);
 
 /* Game Operation */
 int exit_game(int exitCondition);
 void init_game(Card (*playCard)(struct PlayerInfo*, bool, Card, bool), 
         int argv, char** argc);
 void run_round(PlayerInfo* game);
-void watch_round(PlayerInfo* game, int leadPlayer, int* winners); 
-void make_move(PlayerInfo* game); 
+void new_game(PlayerInfo* game, int handSize);
+void watch_round(PlayerInfo* game, int leadPlayer, int* winners);
+Card make_move(PlayerInfo* game, bool isLead, Card lead, bool specialMove);
+
+/* Logging */
+void start_logging(void);
+unsigned char* reserve_sink(LogSink* sink, int size);
+void flush_sink(LogSink* sink);
+void flush_logs(void);
+void log_seat(PlayerInfo* game);
+void log_round(int leadPlayer, Card* played, int cardCount);
+void log_game(PlayerInfo* game);
 
 /* Utility */
-char* read_new_line(FILE* toRead, char** line);
-Card find_extremum(Card* hand, int handSize, 
-        int (*compRank)(int, int), char* order);
+char* read_new_line(LineReader* reader);
 
 #endif // _PLAYER_H_
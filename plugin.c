@@ -0,0 +1,9 @@
+#include "strategy.h"
+
+/**
+ * The entry point the hub looks up when it loads this plugin. 
+ * PLUGIN_STRATEGY is defined at build time to the strategy to export.
+ */ 
+Card play_card(PlayerInfo* game, bool isLead, Card lead, bool specialMove) {
+    return PLUGIN_STRATEGY(game, isLead, lead, specialMove);
+}
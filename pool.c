@@ -0,0 +1,69 @@
+#include "pool.h"
+
+/**
+ * Start a process for each player argument, without its seat. Arguments 
+ * that are not programs, such as in-process strategies, are not started.
+ * 
+ * @param pool - The pool to fill.
+ * @param names - The player arguments.
+ * @param count - The number of player arguments.
+ */ 
+void fill_pool(PlayerPool* pool, char** names, int count) {
+    pool->spares = malloc(sizeof(Spare) * count);
+    pool->count = count;
+
+    // Spares learn the protocol from their seat, not the environment.
+    setenv(POOL_VARIABLE, POOL_WAITING, true);
+    unsetenv(PROTOCOL_VARIABLE);
+    raise_file_limit();
+    for (int i = 0; i < count; i++) {
+        char* args[] = {names[i], NULL};
+        pool->spares[i].name = names[i];
+        pool->spares[i].started = start_process(args, 
+                &pool->spares[i].process);
+        pool->spares[i].taken = false;
+    }
+    unsetenv(POOL_VARIABLE);
+}
+
+/**
+ * Take a spare started from a program, to seat it.
+ * 
+ * @param pool - The pool to take from.
+ * @param name - The program as named on the command line.
+ * @return The spare, or NULL if there are none left of the program.
+ */ 
+Spare* take_spare(PlayerPool* pool, const char* name) {
+    for (int i = 0; i < pool->count; i++) {
+        Spare* spare = &pool->spares[i];
+        if (!spare->taken && !strcmp(spare->name, name)) {
+            spare->taken = true;
+            return spare;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * End the spares that were never seated and free the pool.
+ * 
+ * @param pool - The pool to empty.
+ */ 
+void empty_pool(PlayerPool* pool) {
+    for (int i = 0; i < pool->count; i++) {
+        Process* process = &pool->spares[i].process;
+        if (pool->spares[i].taken) {
+            continue;
+        }
+        if (process->track != -1) {
+            kill(process->track, SIGKILL);
+            waitpid(process->track, NULL, 0);
+        }
+        if (process->read != -1) {
+            close(process->read);
+            close(process->write);
+            close(process->error);
+        }
+    }
+    free(pool->spares);
+}
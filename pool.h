@@ -0,0 +1,39 @@
+#ifndef _POOL_H_
+#define _POOL_H_
+
+#include "2310hub.h"
+
+/**
+ * A player process started without a seat, which says it is waiting 
+ * once it has started up and is then told its seat.
+ * 
+ * @param name - The program as named on the command line
+ * @param process - The process
+ * @param started - Whether the program was executed
+ * @param taken - Whether it has been given a seat
+ */ 
+typedef struct {
+    const char* name;
+    Process process;
+    bool started;
+    bool taken;
+} Spare;
+
+/**
+ * Player processes started before the game is set up, so that they start 
+ * up while the decks are read and dealt.
+ * 
+ * @param spares - One process for each player argument
+ * @param count - The number of spares
+ */ 
+typedef struct PlayerPool {
+    Spare* spares;
+    int count;
+} PlayerPool;
+
+/* Player pool */
+void fill_pool(PlayerPool* pool, char** names, int count);
+Spare* take_spare(PlayerPool* pool, const char* name);
+void empty_pool(PlayerPool* pool);
+
+#endif // _POOL_H_
@@ -0,0 +1,343 @@
+#include "report.h"
+
+/* The report flushed when the hub exits, however it exits. */
+static Report* exitReport = NULL;
+
+/**
+ * Find the format a report is named by on the command line.
+ * 
+ * @param name - text, quiet, csv or json.
+ * @param format - Where to store the format.
+ * @return Whether the name was valid.
+ */ 
+bool find_format(const char* name, int* format) {
+    const char* names[] = {"text", "quiet", "csv", "json"};
+    for (int i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        if (!strcmp(name, names[i])) {
+            *format = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Start a report, which is flushed when the process exits.
+ * 
+ * @param report - The report to start.
+ * @param format - REPORT_TEXT, REPORT_QUIET, REPORT_CSV or REPORT_JSON.
+ * @param fd - Where to write the report.
+ */ 
+void open_report(Report* report, int format, int fd) {
+    *report = (Report) {.format = format, .fd = fd,
+            .buffer = malloc(REPORT_BUFFER), .length = 0, 
+            .eager = isatty(fd), .lead = 0, .round = 0};
+    if (!exitReport) {
+        atexit(flush_at_exit);
+    }
+    exitReport = report;
+    if (format == REPORT_CSV) {
+        append_text(report, CSV_HEADER);
+        end_record(report);
+    }
+}
+
+/**
+ * Write out everything buffered in a report.
+ * 
+ * @param report - The report to flush.
+ */ 
+void flush_report(Report* report) {
+    int written = 0;
+    while (written < report->length) {
+        ssize_t bytes = write(report->fd, report->buffer + written, 
+                report->length - written);
+        if (bytes == -1 && errno != EINTR) {
+            // Like stdio, output that cannot be written is dropped.
+            break;
+        }
+        written += (bytes > 0) ? bytes : 0;
+    }
+    report->length = 0;
+}
+
+/**
+ * Flush the report left open when the process exits.
+ */ 
+void flush_at_exit(void) {
+    if (exitReport) {
+        flush_report(exitReport);
+    }
+}
+
+/**
+ * Report the player leading a round as it begins.
+ * 
+ * @param report - The report to add to.
+ * @param lead - The lead player.
+ */ 
+void report_lead(Report* report, int lead) {
+    report->lead = lead;
+    if (report->format == REPORT_TEXT) {
+        append_text(report, "Lead player=");
+        append_long(report, lead);
+        append_char(report, '\n');
+        end_record(report);
+    }
+}
+
+/**
+ * Report the cards played in a round once it is over.
+ * 
+ * @param report - The report to add to.
+ * @param game - The game being played.
+ * @param winner - The player who won the round.
+ * @param played - The cards played, starting with the lead.
+ * @param cardCount - The number of cards.
+ */ 
+void report_round(Report* report, int game, int winner, const Card* played, 
+        int cardCount) {
+    int round = report->round++;
+    const char* separator = (report->format == REPORT_JSON) ? ", " : " ";
+    switch (report->format) {
+        case REPORT_TEXT:
+            append_text(report, "Cards=");
+            break;
+        case REPORT_CSV:
+            append_text(report, "round,");
+            append_long(report, game);
+            append_char(report, ',');
+            append_long(report, round);
+            append_char(report, ',');
+            append_long(report, report->lead);
+            append_char(report, ',');
+            append_long(report, winner);
+            append_char(report, ',');
+            break;
+        case REPORT_JSON:
+            append_text(report, "{\"record\": \"round\", \"game\": ");
+            append_long(report, game);
+            append_text(report, ", \"round\": ");
+            append_long(report, round);
+            append_text(report, ", \"lead\": ");
+            append_long(report, report->lead);
+            append_text(report, ", \"winner\": ");
+            append_long(report, winner);
+            append_text(report, ", \"cards\": [");
+            break;
+        default:
+            return;
+    }
+
+    for (int i = 0; i < cardCount; i++) {
+        append_text(report, i ? separator : "");
+        append_text(report, (report->format == REPORT_JSON) ? "\"" : "");
+        append_card(report, played[i]);
+        append_text(report, (report->format == REPORT_JSON) ? "\"" : "");
+    }
+    append_text(report, (report->format == REPORT_CSV) ? ",,\n" : 
+            (report->format == REPORT_JSON) ? "]}\n" : "\n");
+    end_record(report);
+}
+
+/**
+ * Report the final scores of a game.
+ * 
+ * @param report - The report to add to.
+ * @param game - The game that was played.
+ * @param scores - The score of each player.
+ * @param playerCount - The number of players.
+ */ 
+void report_scores(Report* report, int game, const int* scores, 
+        int playerCount) {
+    long values[playerCount];
+    for (int i = 0; i < playerCount; i++) {
+        values[i] = scores[i];
+    }
+    report->round = 0;
+
+    switch (report->format) {
+        case REPORT_CSV:
+            append_text(report, "game,");
+            append_long(report, game);
+            append_text(report, ",,,,,");
+            append_list(report, " ", values, playerCount, false);
+            append_text(report, ",\n");
+            break;
+        case REPORT_JSON:
+            append_text(report, "{\"record\": \"game\", \"game\": ");
+            append_long(report, game);
+            append_text(report, ", \"scores\": [");
+            append_list(report, ", ", values, playerCount, false);
+            append_text(report, "]}\n");
+            break;
+        default:
+            append_list(report, " ", values, playerCount, true);
+            append_char(report, '\n');
+    }
+    end_record(report);
+}
+
+/**
+ * Report the results of a run of games.
+ * 
+ * @param report - The report to add to.
+ * @param totals - The results.
+ */ 
+void report_totals(Report* report, const Totals* totals) {
+    char number[REPORT_NUMBER];
+    int count = totals->playerCount;
+
+    switch (report->format) {
+        case REPORT_CSV:
+            append_text(report, "totals,");
+            append_long(report, totals->games);
+            append_text(report, ",,,,,");
+            append_list(report, " ", totals->scores, count, false);
+            append_char(report, ',');
+            append_list(report, " ", totals->wins, count, false);
+            append_char(report, '\n');
+            break;
+        case REPORT_JSON:
+            append_text(report, "{\"record\": \"totals\", \"games\": ");
+            append_long(report, totals->games);
+            snprintf(number, sizeof(number), "%.3f", totals->seconds);
+            append_text(report, ", \"seconds\": ");
+            append_text(report, number);
+            append_text(report, ", \"scores\": [");
+            append_list(report, ", ", totals->scores, count, false);
+            append_text(report, "], \"wins\": [");
+            append_list(report, ", ", totals->wins, count, false);
+            append_text(report, "], \"messages\": ");
+            append_long(report, totals->messages);
+            append_text(report, ", \"writes\": ");
+            append_long(report, totals->writes);
+            append_text(report, "}\n");
+            break;
+        default:
+            append_text(report, "Games=");
+            append_long(report, totals->games);
+            snprintf(number, sizeof(number), " Time=%.3f Rate=%.1f\n", 
+                    totals->seconds, (totals->seconds > 0) 
+                    ? totals->games / totals->seconds : 0);
+            append_text(report, number);
+            append_text(report, "Totals=");
+            append_list(report, " ", totals->scores, count, true);
+            append_text(report, "\nWins=");
+            append_list(report, " ", totals->wins, count, true);
+            append_char(report, '\n');
+
+            // Without coalescing every message would take at least one 
+            // write.
+            if (totals->messages > 0) {
+                append_text(report, "Messages=");
+                append_long(report, totals->messages);
+                append_text(report, " Writes=");
+                append_long(report, totals->writes);
+                append_text(report, " Saved=");
+                append_long(report, totals->messages - totals->writes);
+                append_char(report, '\n');
+            }
+    }
+    end_record(report);
+}
+
+/**
+ * Add text to a report, writing out the buffer first if it is full.
+ * 
+ * @param report - The report to add to.
+ * @param text - The text to add.
+ */ 
+void append_text(Report* report, const char* text) {
+    int length = strlen(text);
+    if (report->length + length > REPORT_BUFFER) {
+        flush_report(report);
+    }
+    if (length > REPORT_BUFFER) {
+        // Too long to ever buffer.
+        write(report->fd, text, length);
+        return;
+    }
+    memcpy(report->buffer + report->length, text, length);
+    report->length += length;
+}
+
+/**
+ * Add a character to a report.
+ * 
+ * @param report - The report to add to.
+ * @param c - The character to add.
+ */ 
+void append_char(Report* report, char c) {
+    if (report->length == REPORT_BUFFER) {
+        flush_report(report);
+    }
+    report->buffer[report->length++] = c;
+}
+
+/**
+ * Add a number to a report in decimal, without going through printf.
+ * 
+ * @param report - The report to add to.
+ * @param value - The number to add.
+ */ 
+void append_long(Report* report, long value) {
+    char digits[REPORT_NUMBER];
+    int start = sizeof(digits) - 1;
+    unsigned long magnitude = (value < 0) ? -(unsigned long) value : value;
+
+    digits[start] = '\0';
+    do {
+        digits[--start] = '0' + magnitude % 10;
+        magnitude /= 10;
+    } while (magnitude);
+    if (value < 0) {
+        digits[--start] = '-';
+    }
+    append_text(report, digits + start);
+}
+
+/**
+ * Add a card to a report as its suit and rank separated by a dot.
+ * 
+ * @param report - The report to add to.
+ * @param card - The card to add.
+ */ 
+void append_card(Report* report, Card card) {
+    append_char(report, card.suit);
+    append_char(report, '.');
+    append_char(report, card.rank);
+}
+
+/**
+ * Add a list of numbers to a report.
+ * 
+ * @param report - The report to add to.
+ * @param separator - What goes between the numbers.
+ * @param values - The numbers.
+ * @param count - The number of numbers.
+ * @param indexed - Whether to precede each number with its index and a 
+ *      colon, as players are listed in text.
+ */ 
+void append_list(Report* report, const char* separator, const long* values, 
+        int count, bool indexed) {
+    for (int i = 0; i < count; i++) {
+        append_text(report, i ? separator : "");
+        if (indexed) {
+            append_long(report, i);
+            append_char(report, ':');
+        }
+        append_long(report, values[i]);
+    }
+}
+
+/**
+ * Finish a record, writing it out straight away if a person is watching.
+ * 
+ * @param report - The report the record was added to.
+ */ 
+void end_record(Report* report) {
+    if (report->eager) {
+        flush_report(report);
+    }
+}
@@ -0,0 +1,91 @@
+#ifndef _REPORT_H_
+#define _REPORT_H_
+
+#include "utilities.h"
+
+#define REPORT_TEXT 0
+#define REPORT_QUIET 1
+#define REPORT_CSV 2
+#define REPORT_JSON 3
+
+#define REPORT_BUFFER 65536
+#define REPORT_NUMBER 64
+#define CSV_HEADER "record,game,round,lead,winner,cards,scores,wins\n"
+
+/**
+ * The results a hub prints to stdout. Each record is formatted by hand 
+ * into one reused buffer, which is written out only once it fills, when 
+ * the hub exits or, if a person is watching a terminal, after every 
+ * record.
+ * 
+ * The formats are:
+ *  REPORT_TEXT - the lead and cards of every round, then the scores 
+ *  REPORT_QUIET - only the scores of each game 
+ *  REPORT_CSV - a row per round, per game and for the totals under 
+ *      CSV_HEADER, with lists of cards or scores separated by spaces 
+ *  REPORT_JSON - an object per round, per game and for the totals, one 
+ *      per line
+ * 
+ * @param format - One of the formats above
+ * @param fd - Where the report is written
+ * @param buffer - Records not yet written
+ * @param length - The bytes in the buffer
+ * @param eager - Whether to write each record as soon as it is complete
+ * @param lead - The player leading the current round
+ * @param round - The rounds reported so far in the current game
+ */ 
+typedef struct {
+    int format;
+    int fd;
+    char* buffer;
+    int length;
+    bool eager;
+    int lead;
+    int round;
+} Report;
+
+/**
+ * The results of a run of games, summed over each player.
+ * 
+ * @param games - The games played
+ * @param seconds - The time they took
+ * @param playerCount - The number of players
+ * @param scores - The final scores of each player summed
+ * @param wins - The games each player had the top score in
+ * @param messages - The messages sent to player processes
+ * @param writes - The writes they took
+ */ 
+typedef struct {
+    int games;
+    double seconds;
+    int playerCount;
+    long* scores;
+    long* wins;
+    long messages;
+    long writes;
+} Totals;
+
+/* Setup */
+bool find_format(const char* name, int* format);
+void open_report(Report* report, int format, int fd);
+void flush_report(Report* report);
+void flush_at_exit(void);
+
+/* Records */
+void report_lead(Report* report, int lead);
+void report_round(Report* report, int game, int winner, const Card* played, 
+        int cardCount);
+void report_scores(Report* report, int game, const int* scores, 
+        int playerCount);
+void report_totals(Report* report, const Totals* totals);
+
+/* Formatting */
+void append_text(Report* report, const char* text);
+void append_char(Report* report, char c);
+void append_long(Report* report, long value);
+void append_card(Report* report, Card card);
+void append_list(Report* report, const char* separator, const long* values, 
+        int count, bool indexed);
+void end_record(Report* report);
+
+#endif // _REPORT_H_
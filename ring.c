@@ -0,0 +1,270 @@
+#include "ring.h"
+
+/**
+ * Create a ring large enough for the broadcasts of a table.
+ * 
+ * @param ring - The ring to create.
+ * @param playerCount - The number of players reading it.
+ * @return Whether the ring was created.
+ */ 
+bool create_ring(Ring* ring, int playerCount) {
+    // Two rounds of messages, with room for NEWGAME and GAMEOVER.
+    uint64_t needed = (2 * (uint64_t) playerCount + RING_SLACK)
+            * RING_MESSAGE;
+    uint32_t capacity = RING_ALIGN;
+    while (capacity < needed) {
+        capacity <<= 1;
+    }
+
+    // memfd_create is only declared with _GNU_SOURCE. The file is left 
+    // open across exec so that players inherit it.
+    ring->fd = syscall(SYS_memfd_create, RING_NAME, 0);
+    ring->size = RING_ALIGN + capacity + sizeof(Mailbox) * playerCount;
+    ring->read = 0;
+    ring->spins = (sysconf(_SC_NPROCESSORS_ONLN) > 1) ? MAILBOX_SPINS : 0;
+    if (ring->fd == -1) {
+        return false;
+    } else if (ftruncate(ring->fd, ring->size) || !map_ring(ring, 
+            PROT_READ | PROT_WRITE)) {
+        close(ring->fd);
+        return false;
+    }
+    // The file starts zeroed, so nothing has been written.
+    ring->header->capacity = capacity;
+    ring->header->mailboxCount = playerCount;
+    ring->mailboxes = (Mailbox*) (ring->data + capacity);
+    return true;
+}
+
+/**
+ * Map a rings file. The mailboxes are only found once the capacity is 
+ * known.
+ * 
+ * @param ring - The ring, with its file and size.
+ * @param protection - How the mapping may be used.
+ * @return Whether the file was mapped.
+ */ 
+bool map_ring(Ring* ring, int protection) {
+    void* mapped = mmap(NULL, ring->size, protection, MAP_SHARED, ring->fd, 
+            0);
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+    ring->header = mapped;
+    ring->data = (unsigned char*) mapped + RING_ALIGN;
+    return true;
+}
+
+/**
+ * Append a message to a ring. Readers see none of it until all of it is 
+ * there.
+ * 
+ * @param ring - The ring to write to.
+ * @param bytes - The message in the binary protocol, a broadcast of at 
+ *      most RING_MESSAGE bytes.
+ * @param count - The number of bytes.
+ */ 
+void append_ring(Ring* ring, const unsigned char* bytes, int count) {
+    uint64_t written = ring->header->written;
+    uint32_t mask = ring->header->capacity - 1;
+    // A reader that sees any of these bytes also sees every earlier 
+    // append published, so at most this one can be unpublished.
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    for (int i = 0; i < count; i++) {
+        ring->data[(written + i) & mask] = bytes[i];
+    }
+    __atomic_store_n(&ring->header->written, written + count, 
+            __ATOMIC_RELEASE);
+}
+
+/**
+ * Unmap a ring and close its file.
+ * 
+ * @param ring - The ring to free.
+ */ 
+void free_ring(Ring* ring) {
+    munmap(ring->header, ring->size);
+    close(ring->fd);
+}
+
+/**
+ * Map a ring inherited from the hub, to read from what is written next.
+ * 
+ * @param ring - The ring to attach.
+ * @param fd - The number of the inherited file, as text.
+ * @return Whether fd is a ring that could be mapped.
+ */ 
+bool attach_ring(Ring* ring, const char* fd) {
+    struct stat info;
+    if ((ring->fd = read_int((char*) fd)) < 0 || fstat(ring->fd, &info)
+            || info.st_size <= RING_ALIGN) {
+        return false;
+    }
+    ring->size = info.st_size;
+    // Players write to their mailboxes.
+    if (!map_ring(ring, PROT_READ | PROT_WRITE)) {
+        return false;
+    }
+    uint32_t capacity = ring->header->capacity;
+    if (!capacity || capacity & (capacity - 1) || RING_ALIGN + capacity
+            + sizeof(Mailbox) * ring->header->mailboxCount != ring->size) {
+        munmap(ring->header, ring->size);
+        return false;
+    }
+    ring->mailboxes = (Mailbox*) (ring->data + capacity);
+    ring->read = __atomic_load_n(&ring->header->written, __ATOMIC_ACQUIRE);
+    ring->spins = (sysconf(_SC_NPROCESSORS_ONLN) > 1) ? MAILBOX_SPINS : 0;
+    return true;
+}
+
+/**
+ * Read the next message from a ring.
+ * 
+ * @param ring - The ring to read from.
+ * @param message - Set to the message read.
+ * @return The bytes used, 0 if none have been written, or -1 if the 
+ *      message is not a broadcast or the hub has written over it.
+ */ 
+int read_ring(Ring* ring, Message* message) {
+    RingHeader* header = ring->header;
+    uint64_t written = __atomic_load_n(&header->written, __ATOMIC_ACQUIRE);
+    uint64_t waiting = written - ring->read;
+    int length = (waiting < RING_MESSAGE) ? waiting : RING_MESSAGE;
+    unsigned char bytes[RING_MESSAGE];
+
+    if (waiting > header->capacity) {
+        return -1;
+    }
+    for (int i = 0; i < length; i++) {
+        bytes[i] = ring->data[(ring->read + i) & (header->capacity - 1)];
+    }
+    // The bytes are only good if they weren't written over while copied. 
+    // The hub stores an append before publishing it, so one it is still 
+    // making may have reached them unseen.
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&header->written, __ATOMIC_RELAXED) + RING_MESSAGE 
+            - ring->read > header->capacity) {
+        return -1;
+    }
+
+    int used = decode_message(bytes, length, message);
+    if (used > 0 && message->type == MESSAGE_HAND) {
+        free(message->cards);
+        return -1;
+    } else if ((used == 0 && length == RING_MESSAGE) || (used > 0
+            && (message->type == MESSAGE_PLAY
+            || message->type == MESSAGE_WAKE))) {
+        return -1;
+    } else if (used > 0) {
+        ring->read += used;
+    }
+    return used;
+}
+
+/**
+ * Find the mailbox of a player.
+ * 
+ * @param ring - The ring holding the mailboxes.
+ * @param player - The seat of the player.
+ * @return The mailbox, or NULL if the ring has none for the player.
+ */ 
+Mailbox* mailbox_of(Ring* ring, int player) {
+    if (player < 0 || player >= ring->header->mailboxCount) {
+        return NULL;
+    }
+    return &ring->mailboxes[player];
+}
+
+/**
+ * Give a player the turn, once everything it needs is in the ring.
+ * 
+ * @param mailbox - The players mailbox.
+ */ 
+void signal_turn(Mailbox* mailbox) {
+    __atomic_add_fetch(&mailbox->turns, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&mailbox->playerWaiting, __ATOMIC_SEQ_CST)) {
+        futex(&mailbox->turns, FUTEX_WAKE, 1, -1);
+    }
+}
+
+/**
+ * Wait for the hub to give a player the turn.
+ * 
+ * @param ring - The ring holding the mailbox.
+ * @param mailbox - The players mailbox.
+ * @param seen - The turns counted before the ring was found empty.
+ */ 
+void await_turn(Ring* ring, Mailbox* mailbox, uint32_t seen) {
+    for (int i = 0; i < ring->spins; i++) {
+        if (__atomic_load_n(&mailbox->turns, __ATOMIC_ACQUIRE) != seen) {
+            return;
+        }
+    }
+    // The hub checks playerWaiting after bumping turns, so either it sees 
+    // the player is waiting or the player sees the new turn.
+    __atomic_store_n(&mailbox->playerWaiting, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&mailbox->turns, __ATOMIC_SEQ_CST) == seen) {
+        futex(&mailbox->turns, FUTEX_WAIT, seen, -1);
+    }
+    __atomic_store_n(&mailbox->playerWaiting, 0, __ATOMIC_RELAXED);
+}
+
+/**
+ * Hand a players card to the hub.
+ * 
+ * @param mailbox - The players mailbox.
+ * @param card - The card played, as encode_card makes.
+ */ 
+void post_reply(Mailbox* mailbox, unsigned char card) {
+    mailbox->card = card;
+    __atomic_add_fetch(&mailbox->replies, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&mailbox->hubWaiting, __ATOMIC_SEQ_CST)) {
+        futex(&mailbox->replies, FUTEX_WAKE, 1, -1);
+    }
+}
+
+/**
+ * Wait a while for a player to play a card.
+ * 
+ * @param ring - The ring holding the mailbox.
+ * @param mailbox - The players mailbox.
+ * @param seen - The replies already taken from the player.
+ * @param timeoutMillis - The longest to sleep for.
+ * @return The replies the player has posted since, which is 0 if it 
+ *      hasn't played yet.
+ */ 
+int await_reply(Ring* ring, Mailbox* mailbox, uint32_t seen, 
+        int timeoutMillis) {
+    uint32_t replies = seen;
+    for (int i = 0; i < ring->spins && replies == seen; i++) {
+        replies = __atomic_load_n(&mailbox->replies, __ATOMIC_ACQUIRE);
+    }
+    if (replies == seen) {
+        __atomic_store_n(&mailbox->hubWaiting, 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&mailbox->replies, __ATOMIC_SEQ_CST) == seen) {
+            futex(&mailbox->replies, FUTEX_WAIT, seen, timeoutMillis);
+        }
+        __atomic_store_n(&mailbox->hubWaiting, 0, __ATOMIC_RELAXED);
+        replies = __atomic_load_n(&mailbox->replies, __ATOMIC_ACQUIRE);
+    }
+    return replies - seen;
+}
+
+/**
+ * Make a futex system call on a word shared between processes, which 
+ * glibc has no wrapper for.
+ * 
+ * @param word - The futex.
+ * @param operation - FUTEX_WAIT or FUTEX_WAKE.
+ * @param value - The value to sleep on, or the sleepers to wake.
+ * @param timeoutMillis - The longest to sleep for, or -1 to sleep until 
+ *      woken.
+ * @return As the system call.
+ */ 
+long futex(uint32_t* word, int operation, uint32_t value, 
+        int timeoutMillis) {
+    struct timespec timeout = {.tv_sec = timeoutMillis / 1000, 
+            .tv_nsec = timeoutMillis % 1000 * 1000000L};
+    return syscall(SYS_futex, word, operation, value, 
+            (timeoutMillis < 0) ? NULL : &timeout, NULL, 0);
+}
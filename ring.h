@@ -0,0 +1,100 @@
+#ifndef _RING_H_
+#define _RING_H_
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <time.h>
+#include "utilities.h"
+
+#define RING_VARIABLE "HUB_RING"
+#define RING_NAME "2310ring"
+#define RING_SLACK 4
+#define RING_ALIGN 64
+// The largest broadcast: an opcode, a player and a card.
+#define RING_MESSAGE (2 + MAX_VARINT)
+#define MAILBOX_SPINS 2000
+
+/**
+ * The start of a ring, shared by the hub and every player mapping it. The 
+ * messages follow at RING_ALIGN bytes, then a mailbox for each player.
+ * 
+ * @param written - The bytes ever appended, stored once a message is whole
+ * @param capacity - The size of the ring, a power of two
+ * @param mailboxCount - The number of mailboxes
+ */ 
+typedef struct {
+    uint64_t written;
+    uint32_t capacity;
+    uint32_t mailboxCount;
+} RingHeader;
+
+/**
+ * Where a player and the hub pass the turn between them without pipes. 
+ * Each side bumps a counter to hand over and sleeps on the other's with a 
+ * futex. A side only sleeps after saying it will, so the other only makes 
+ * a system call to wake it when it has to. Mailboxes have a cache line 
+ * each so that players don't slow each other down.
+ * 
+ * @param turns - Bumped by the hub each time it waits on the player
+ * @param replies - Bumped by the player once its card is in place
+ * @param playerWaiting - Whether the player may be asleep on turns
+ * @param hubWaiting - Whether the hub may be asleep on replies
+ * @param card - The players last card, as encode_card makes
+ */ 
+typedef struct {
+    uint32_t turns;
+    uint32_t replies;
+    uint32_t playerWaiting;
+    uint32_t hubWaiting;
+    unsigned char card;
+} __attribute__((aligned(RING_ALIGN))) Mailbox;
+
+/**
+ * A shared memory ring the hub appends every broadcast message to once, in 
+ * the binary protocol, for all players to read. The hub never waits for 
+ * readers: a player reads everything before its turn, so none falls more 
+ * than two rounds behind, and the ring is sized to hold that much. A 
+ * reader that is overtaken anyway sees it and gives up.
+ * 
+ * @param fd - The shared memory file, inherited by players
+ * @param header - The mapped header
+ * @param data - The mapped messages
+ * @param mailboxes - The mapped mailboxes
+ * @param size - The size of the mapping
+ * @param read - The bytes this reader has used
+ * @param spins - How long to spin before sleeping on a mailbox, which is 
+ *      only worth doing if the other side can run at the same time
+ */ 
+typedef struct {
+    int fd;
+    RingHeader* header;
+    unsigned char* data;
+    Mailbox* mailboxes;
+    size_t size;
+    uint64_t read;
+    int spins;
+} Ring;
+
+/* Writing */
+bool create_ring(Ring* ring, int playerCount);
+bool map_ring(Ring* ring, int protection);
+void append_ring(Ring* ring, const unsigned char* bytes, int count);
+void free_ring(Ring* ring);
+
+/* Reading */
+bool attach_ring(Ring* ring, const char* fd);
+int read_ring(Ring* ring, Message* message);
+
+/* Mailboxes */
+Mailbox* mailbox_of(Ring* ring, int player);
+void signal_turn(Mailbox* mailbox);
+void await_turn(Ring* ring, Mailbox* mailbox, uint32_t seen);
+void post_reply(Mailbox* mailbox, unsigned char card);
+int await_reply(Ring* ring, Mailbox* mailbox, uint32_t seen, 
+        int timeoutMillis);
+long futex(uint32_t* word, int operation, uint32_t value, 
+        int timeoutMillis);
+
+#endif // _RING_H_
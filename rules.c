@@ -0,0 +1,108 @@
+#include "rules.h"
+
+/**
+ * Compile a strategy description into a table.
+ * 
+ * @param path - The description, as StrategyTable describes it.
+ * @param table - Set to the table.
+ * @return Whether the description was valid and had a rule for every 
+ *      situation.
+ */ 
+bool read_table(const char* path, StrategyTable* table) {
+    FILE* description = fopen(path, "r");
+    bool seen[SITUATION_COUNT][2] = {{false}};
+    bool valid = description != NULL;
+    char* line;
+
+    while (valid && read_line(description, &line)) {
+        valid = parse_rule(line, table, &seen[0][0]);
+        free(line);
+    }
+    if (description) {
+        fclose(description);
+    }
+    for (int i = 0; valid && i < SITUATION_COUNT; i++) {
+        valid = seen[i][false];
+        if (!seen[i][true]) {
+            table->rules[i][true] = table->rules[i][false];
+        }
+    }
+    return valid;
+}
+
+/**
+ * Read one line of a strategy description.
+ * 
+ * @param line - The line, which is split up as it is read.
+ * @param table - The table to add the rule to.
+ * @param seen - Marked for each rule read, as table->rules is laid out.
+ * @return Whether the line was a valid rule, comment or blank line.
+ */ 
+bool parse_rule(char* line, StrategyTable* table, bool* seen) {
+    const char* situations[] = {RULE_LEAD, RULE_FOLLOW, RULE_DISCARD};
+    const char* separators = " \t";
+    char* position;
+    char* word = strtok_r(line, separators, &position);
+    if (!word || word[0] == RULE_COMMENT) {
+        return true;
+    }
+
+    int situation = -1;
+    for (int i = 0; i < SITUATION_COUNT; i++) {
+        situation = strcmp(word, situations[i]) ? situation : i;
+    }
+    bool special = false;
+    if ((word = strtok_r(NULL, separators, &position)) 
+            && !strcmp(word, RULE_SPECIAL)) {
+        special = true;
+        word = strtok_r(NULL, separators, &position);
+    }
+    Rule rule;
+    char* extremum = strtok_r(NULL, separators, &position);
+    if (situation == -1 || !word || !parse_order(word, &rule) || !extremum 
+            || strtok_r(NULL, separators, &position)) {
+        return false;
+    } else if (!strcmp(extremum, RULE_HIGHEST) 
+            || !strcmp(extremum, RULE_LOWEST)) {
+        rule.highest = !strcmp(extremum, RULE_HIGHEST);
+    } else {
+        return false;
+    }
+
+    // Nothing has been led when leading.
+    for (int i = 0; i < rule.count; i++) {
+        if (situation == SITUATION_LEAD && rule.suits[i] == FOLLOW_SUIT) {
+            return false;
+        }
+    }
+    table->rules[situation][special] = rule;
+    seen[situation * 2 + special] = true;
+    return true;
+}
+
+/**
+ * Read the order suits are tried in.
+ * 
+ * @param order - Suits from SUITS, or LEAD_SUIT, each at most once.
+ * @param rule - Set to try the suits in that order.
+ * @return Whether the order was valid.
+ */ 
+bool parse_order(const char* order, Rule* rule) {
+    rule->count = strlen(order);
+    if (rule->count > SUIT_COUNT) {
+        return false;
+    }
+    for (int i = 0; i < rule->count; i++) {
+        rule->suits[i] = (order[i] == LEAD_SUIT) ? FOLLOW_SUIT 
+                : suit_index(order[i]);
+        if (order[i] != LEAD_SUIT && rule->suits[i] == -1) {
+            return false;
+        }
+        for (int j = 0; j < i; j++) {
+            if (rule->suits[j] == rule->suits[i]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,11 @@
+#ifndef _RULES_H_
+#define _RULES_H_
+
+#include "strategy.h"
+
+/* Strategy tables */
+bool read_table(const char* path, StrategyTable* table);
+bool parse_rule(char* line, StrategyTable* table, bool* seen);
+bool parse_order(const char* order, Rule* rule);
+
+#endif // _RULES_H_
@@ -0,0 +1,188 @@
+#include "runner.h"
+
+/**
+ * Play every deck in a set on a pool of worker threads. Each worker plays 
+ * a contiguous block of decks and steals from the others once it runs out.
+ * 
+ * @param game - The threshold and player count of every game. Totals and 
+ *      wins for each player are stored in its players.
+ * @param strategies - The strategy of each player.
+ * @param decks - The decks to play, one game each.
+ * @param workerCount - The number of worker threads.
+ * @param scores - Filled with the final scores of each game in deck order, 
+ *      unless it is NULL.
+ * @return The first error encountered, otherwise NORMAL_EXIT.
+ */ 
+int run_parallel(HubInfo* game, Strategy* strategies, DeckSet* decks, 
+        int workerCount, int* scores) {
+    Runner runner = {.game = game, .strategies = strategies, 
+            .decks = decks, .workerCount = workerCount, .scores = scores, 
+            .status = NORMAL_EXIT};
+    Worker* workers = malloc(sizeof(Worker) * workerCount);
+    runner.queues = malloc(sizeof(WorkQueue) * workerCount);
+
+    for (int i = 0; i < workerCount; i++) {
+        runner.queues[i].next = decks->count * (long) i / workerCount;
+        runner.queues[i].end = decks->count * (long) (i + 1) / workerCount;
+        pthread_mutex_init(&runner.queues[i].lock, NULL);
+    }
+    int started = 0;
+    for (int i = 0; i < workerCount; i++) {
+        workers[i].runner = &runner;
+        workers[i].id = i;
+        workers[i].game.players = NULL;
+        workers[i].started = !pthread_create(&workers[i].thread, NULL, 
+                run_worker, &workers[i]);
+        started += workers[i].started;
+    }
+    // The games of workers without a thread are stolen by the others, or 
+    // played here if no thread could be created at all.
+    if (!started) {
+        run_worker(&workers[0]);
+    }
+
+    // Merge the results of each worker.
+    game->players = calloc(game->playerCount, sizeof(Player));
+    game->games = decks->count;
+    for (int i = 0; i < workerCount; i++) {
+        if (workers[i].started) {
+            pthread_join(workers[i].thread, NULL);
+        }
+        for (int j = 0; workers[i].game.players 
+                && j < game->playerCount; j++) {
+            game->players[j].totalScore += 
+                    workers[i].game.players[j].totalScore;
+            game->players[j].squaredScore += 
+                    workers[i].game.players[j].squaredScore;
+            game->players[j].wins += workers[i].game.players[j].wins;
+            free(workers[i].game.players[j].hand);
+            free(workers[i].game.players[j].local->hand);
+            free(workers[i].game.players[j].local);
+        }
+        free(workers[i].game.players);
+        pthread_mutex_destroy(&runner.queues[i].lock);
+    }
+    free(runner.queues);
+    free(workers);
+    return runner.status;
+}
+
+/**
+ * Play games until there are none left to take.
+ * 
+ * @param worker - The worker being run.
+ * @return NULL
+ */ 
+void* run_worker(void* worker) {
+    Worker* self = worker;
+    Runner* runner = self->runner;
+    HubInfo* game = &self->game;
+    int index;
+    int status;
+    unsigned char* buffer = malloc(deck_buffer_size(runner->decks));
+
+    game->threshold = runner->game->threshold;
+    game->playerCount = runner->game->playerCount;
+    game->report = NULL;
+    game->binary = false;
+    game->events = NULL;
+    game->metrics = NULL;
+    game->log = NULL;
+    game->ring = NULL;
+    game->pool = NULL;
+    game->piped = 0;
+    if (runner->game->log) {
+        share_log(&self->log, runner->game->log);
+        game->log = &self->log;
+    }
+    game->players = calloc(game->playerCount, sizeof(Player));
+    for (int i = 0; i < game->playerCount; i++) {
+        create_local(game, i, runner->strategies[i]);
+    }
+
+    // Stop early once any worker has failed.
+    while (__atomic_load_n(&runner->status, __ATOMIC_RELAXED) == NORMAL_EXIT
+            && next_game(self, &index)) {
+        Deck deck;
+        if (!deck_at(runner->decks, index, buffer, &deck)) {
+            status = ERROR_DECK;
+        } else {
+            game->deck = deck.cards;
+            game->deckSize = deck.size;
+            game->games = index;
+            status = new_game(game);
+        }
+
+        if (status != NORMAL_EXIT 
+                || (status = run_game(game)) != NORMAL_EXIT) {
+            int expected = NORMAL_EXIT;
+            __atomic_compare_exchange_n(&runner->status, &expected, status, 
+                    false, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+            break;
+        }
+        for (int i = 0; runner->scores && i < game->playerCount; i++) {
+            runner->scores[index * (long) game->playerCount + i] = 
+                    game->players[i].score;
+        }
+    }
+    free(buffer);
+    if (game->log) {
+        free_log(game->log);
+    }
+    return NULL;
+}
+
+/**
+ * Take the next game from a workers queue, stealing more if it is empty.
+ * 
+ * @param worker - The worker wanting a game.
+ * @param game - Set to the index of the game to play.
+ * @return Whether there was a game left to play.
+ */ 
+bool next_game(Worker* worker, int* game) {
+    WorkQueue* queue = &worker->runner->queues[worker->id];
+    do {
+        pthread_mutex_lock(&queue->lock);
+        bool found = queue->next < queue->end;
+        if (found) {
+            *game = queue->next++;
+        }
+        pthread_mutex_unlock(&queue->lock);
+        if (found) {
+            return true;
+        }
+    } while (steal_games(worker));
+    return false;
+}
+
+/**
+ * Move the back half of another workers remaining games onto this worker.
+ * 
+ * @param worker - The worker with an empty queue.
+ * @return Whether any games were stolen.
+ */ 
+bool steal_games(Worker* worker) {
+    Runner* runner = worker->runner;
+    WorkQueue* queue = &runner->queues[worker->id];
+
+    for (int i = 1; i < runner->workerCount; i++) {
+        WorkQueue* victim = &runner->queues[(worker->id + i) 
+                % runner->workerCount];
+        int next, end;
+
+        pthread_mutex_lock(&victim->lock);
+        end = victim->end;
+        // Round up so a single remaining game can still be taken.
+        next = victim->end -= (victim->end - victim->next + 1) / 2;
+        pthread_mutex_unlock(&victim->lock);
+
+        if (next < end) {
+            pthread_mutex_lock(&queue->lock);
+            queue->next = next;
+            queue->end = end;
+            pthread_mutex_unlock(&queue->lock);
+            return true;
+        }
+    }
+    return false;
+}
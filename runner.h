@@ -0,0 +1,67 @@
+#ifndef _RUNNER_H_
+#define _RUNNER_H_
+
+#include <pthread.h>
+#include "game.h"
+
+/**
+ * The games a worker has left to play, which other workers may steal.
+ * 
+ * @param next - The next game to play
+ * @param end - One past the last game to play
+ * @param lock - Guards next and end
+ */ 
+typedef struct {
+    int next;
+    int end;
+    pthread_mutex_t lock;
+} WorkQueue;
+
+/**
+ * State shared by every worker in a parallel run.
+ * 
+ * @param game - The threshold and player count of every game
+ * @param strategies - The strategy of each player
+ * @param decks - The decks to play, one game each
+ * @param workerCount - The number of worker threads
+ * @param queues - One queue of games per worker
+ * @param scores - Final scores, playerCount per game in deck order
+ * @param status - The first error encountered by any worker
+ */ 
+typedef struct {
+    HubInfo* game;
+    Strategy* strategies;
+    DeckSet* decks;
+    int workerCount;
+    WorkQueue* queues;
+    int* scores;
+    int status;
+} Runner;
+
+/**
+ * A single worker thread with its own copy of the game state.
+ * 
+ * @param runner - The shared state of the run
+ * @param id - The index of the workers queue
+ * @param game - The game the worker plays on
+ * @param log - The workers buffer for the shared log, if there is one
+ * @param thread - The thread running the worker
+ * @param started - Whether the thread could be created
+ */ 
+typedef struct {
+    Runner* runner;
+    int id;
+    HubInfo game;
+    GameLog log;
+    pthread_t thread;
+    bool started;
+} Worker;
+
+/* Parallel game running */
+int run_parallel(HubInfo* game, Strategy* strategies, DeckSet* decks, 
+        int workerCount, int* scores);
+void* run_worker(void* worker);
+bool next_game(Worker* worker, int* game);
+bool steal_games(Worker* worker);
+
+#endif // _RUNNER_H_
@@ -0,0 +1,521 @@
+#include "server.h"
+
+volatile sig_atomic_t stopRequested = 0;
+
+/**
+ * Seat players connecting to a socket at tables until SIGINT or SIGTERM, 
+ * then wait for every table to finish the game it is playing and report 
+ * the totals. Never returns.
+ * 
+ * @param game - The threshold, seats and protocol of every table.
+ * @param argv - A list of command line arguments.
+ * @param options - The command line options.
+ */ 
+void run_server(HubInfo* game, char** argv, const HubOptions* options) {
+    DeckSet decks;
+    Server server = {.game = game, .decks = &decks, 
+            .stallMillis = options->stallMillis, .queue = NULL, 
+            .queued = 0, .capacity = 0, .live = NULL, .liveCount = 0, 
+            .room = 0, .closed = NULL, .tables = 0, .games = 0};
+
+    // Without a tournament every table plays the one deck.
+    if (!((options->tournament || options->games) 
+            ? load_decks(options, argv[1], &decks) 
+            : single_deck(argv[1], &decks))) {
+        exit_game(ERROR_DECK);
+    }
+    // Every table deals the first deck, so it is checked once here.
+    server.buffer = malloc(deck_buffer_size(&decks));
+    Deck first;
+    if (!deck_at(&decks, 0, server.buffer, &first)) {
+        exit_game(ERROR_DECK);
+    } else if (first.size < game->playerCount) {
+        exit_game(ERROR_CARD_COUNT);
+    }
+
+    if ((server.listener = open_listener(options->servePath)) == -1 
+            || (server.lobby = epoll_create1(EPOLL_CLOEXEC)) == -1 
+            || (server.epoll = epoll_create1(EPOLL_CLOEXEC)) == -1) {
+        exit_game(ERROR_INCORRECT_ARGS);
+    }
+    // The lobby is the only thing in the servers epoll without a channel.
+    struct epoll_event listen = {.events = EPOLLIN, 
+            .data.fd = server.listener};
+    struct epoll_event lobby = {.events = EPOLLIN, .data.ptr = NULL};
+    epoll_ctl(server.lobby, EPOLL_CTL_ADD, server.listener, &listen);
+    epoll_ctl(server.epoll, EPOLL_CTL_ADD, server.lobby, &lobby);
+
+    // Without SA_RESTART either signal interrupts epoll_wait.
+    struct sigaction stop = {.sa_handler = request_stop};
+    sigaction(SIGINT, &stop, NULL);
+    sigaction(SIGTERM, &stop, NULL);
+    // Tables notice players that leave when reading from them.
+    signal(SIGPIPE, SIG_IGN);
+    raise_file_limit();
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    server.swept = start;
+    while (!stopRequested || server.liveCount) {
+        struct epoll_event events[MAX_EVENTS];
+        if (stopRequested && server.listener != -1) {
+            close_lobby(&server, options->servePath);
+        }
+
+        int ready = epoll_wait(server.epoll, events, MAX_EVENTS, 
+                SWEEP_MILLIS);
+        for (int i = 0; i < ready; i++) {
+            Channel* channel = events[i].data.ptr;
+            if (!channel) {
+                serve_lobby(&server);
+                continue;
+            }
+            // Tables closed earlier in the batch are kept until it ends, 
+            // since later events may still be for their sockets.
+            Table* table = channel->loop->context;
+            if (table->state != TABLE_CLOSED) {
+                service_channel(channel, events[i].events);
+                resume_table(table);
+            }
+        }
+        while (server.listener != -1 
+                && server.queued >= game->playerCount) {
+            open_table(&server);
+        }
+        while (server.closed) {
+            Table* closed = server.closed;
+            server.closed = closed->next;
+            free_table(closed);
+        }
+        if (nanos_since(&server.swept) / 1000000 >= SWEEP_MILLIS) {
+            sweep_tables(&server);
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    printf("Tables=%d Games=%ld Time=%.3f\n", server.tables, server.games, 
+            (end.tv_sec - start.tv_sec) 
+            + (end.tv_nsec - start.tv_nsec) / 1e9);
+    free(server.queue);
+    free(server.live);
+    free(server.buffer);
+    free_decks(&decks);
+    exit_game(NORMAL_EXIT);
+}
+
+/**
+ * Listen on a Unix domain socket. A socket left behind by a server that 
+ * is no longer running is replaced, but nothing else is.
+ * 
+ * @param path - Where to create the socket.
+ * @return The listening socket, or -1 if it could not be created.
+ */ 
+int open_listener(const char* path) {
+    struct sockaddr_un address = {.sun_family = AF_UNIX};
+    struct stat existing;
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        return -1;
+    }
+    strcpy(address.sun_path, path);
+
+    if (!stat(path, &existing) && S_ISSOCK(existing.st_mode)) {
+        int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (connect(probe, (struct sockaddr*) &address, sizeof(address)) 
+                && errno == ECONNREFUSED) {
+            unlink(path);
+        }
+        close(probe);
+    }
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener == -1 || bind(listener, (struct sockaddr*) &address, 
+            sizeof(address)) || listen(listener, SOMAXCONN)) {
+        close(listener);
+        return -1;
+    }
+    fcntl(listener, F_SETFL, fcntl(listener, F_GETFL) | O_NONBLOCK);
+    return listener;
+}
+
+/**
+ * Accept the players that have connected and drop the ones that have left 
+ * while waiting for a seat.
+ * 
+ * @param server - The server whose lobby is ready.
+ */ 
+void serve_lobby(Server* server) {
+    struct epoll_event events[MAX_EVENTS];
+    int ready = epoll_wait(server->lobby, events, MAX_EVENTS, 0);
+    for (int i = 0; i < ready; i++) {
+        if (events[i].data.fd == server->listener) {
+            accept_players(server);
+        } else {
+            // Waiting players have nothing to say, so they have left.
+            drop_player(server, events[i].data.fd);
+        }
+    }
+}
+
+/**
+ * Queue every player waiting to connect for a seat.
+ * 
+ * @param server - The server to queue them on.
+ */ 
+void accept_players(Server* server) {
+    int client;
+    while ((client = accept(server->listener, NULL, NULL)) != -1) {
+        if (server->queued == server->capacity) {
+            server->capacity = server->capacity ? server->capacity * 2 
+                    : server->game->playerCount;
+            server->queue = realloc(server->queue, 
+                    sizeof(int) * server->capacity);
+        }
+        server->queue[server->queued++] = client;
+        struct epoll_event event = {.events = EPOLLIN, .data.fd = client};
+        epoll_ctl(server->lobby, EPOLL_CTL_ADD, client, &event);
+    }
+}
+
+/**
+ * Take a player out of the queue and disconnect it.
+ * 
+ * @param server - The server the player is queued on.
+ * @param client - The players socket.
+ */ 
+void drop_player(Server* server, int client) {
+    for (int i = 0; i < server->queued; i++) {
+        if (server->queue[i] == client) {
+            memmove(server->queue + i, server->queue + i + 1, 
+                    sizeof(int) * (--server->queued - i));
+            epoll_ctl(server->lobby, EPOLL_CTL_DEL, client, NULL);
+            close(client);
+            return;
+        }
+    }
+}
+
+/**
+ * Stop seating players, disconnecting those still waiting.
+ * 
+ * @param server - The server to stop.
+ * @param path - The socket to remove.
+ */ 
+void close_lobby(Server* server, const char* path) {
+    close(server->listener);
+    server->listener = -1;
+    unlink(path);
+    while (server->queued) {
+        drop_player(server, server->queue[0]);
+    }
+    epoll_ctl(server->epoll, EPOLL_CTL_DEL, server->lobby, NULL);
+    close(server->lobby);
+}
+
+/**
+ * Report players that have kept a table waiting too long, and close 
+ * tables whose players have had long enough to read GAMEOVER. Once the 
+ * server is stopping, tables still seating are ended, as are tables that 
+ * have waited on a player for as long as a closing table drains.
+ * 
+ * @param server - The server to check on.
+ */ 
+void sweep_tables(Server* server) {
+    clock_gettime(CLOCK_MONOTONIC, &server->swept);
+    // Closing a table moves the last live table into its place.
+    for (int i = server->liveCount - 1; i >= 0; i--) {
+        Table* table = server->live[i];
+        Turn* turn = &table->game.turn;
+        if (table->state == TABLE_FINISHING 
+                && nanos_since(&table->finishedAt) / 1000000 
+                >= TABLE_DRAIN_MILLIS) {
+            close_table(table);
+        } else if (stopRequested && (table->state == TABLE_SEATING 
+                || (table->state == TABLE_PLAYING && turn->asked 
+                && nanos_since(&turn->askedAt) / 1000000 
+                >= TABLE_DRAIN_MILLIS))) {
+            end_table(table, ERROR_SIGHUP);
+        } else if (table->state == TABLE_PLAYING && turn->asked) {
+            turn->reported = report_stall( 
+                    &table->game.players[turn->current].read, 
+                    &turn->askedAt, turn->reported);
+        } else if (table->state == TABLE_SEATING && unready_seat(table)) {
+            turn->reported = report_stall(unready_seat(table), 
+                    &turn->askedAt, turn->reported);
+        }
+    }
+}
+
+/**
+ * Signal handler asking the server to stop.
+ * 
+ * @param sig - The signal recieved.
+ */ 
+void request_stop(int sig) {
+    stopRequested = 1;
+}
+
+/**
+ * Seat the players who have waited longest at a new table and deal them 
+ * the first deck.
+ * 
+ * @param server - The server to seat them from.
+ */ 
+void open_table(Server* server) {
+    Table* table = malloc(sizeof(Table));
+    HubInfo* game = &table->game;
+    table->server = server;
+    table->id = server->tables++;
+    table->state = TABLE_SEATING;
+
+    if (server->liveCount == server->room) {
+        server->room = server->room ? server->room * 2 : 1;
+        server->live = realloc(server->live, sizeof(Table*) * server->room);
+    }
+    table->index = server->liveCount++;
+    server->live[table->index] = table;
+
+    table->events = (EventLoop) {.epoll = server->epoll, 
+            .stallMillis = server->stallMillis, .writes = 0, 
+            .messages = 0, .interrupted = NULL, .context = table};
+    *game = (HubInfo) {.threshold = server->game->threshold,
+            .playerCount = server->game->playerCount, .games = 0, 
+            .report = NULL, .events = &table->events, 
+            .binary = server->game->binary, .metrics = NULL, .log = NULL, 
+            .ring = NULL, .piped = 0, .mailboxes = false};
+    game->players = calloc(game->playerCount, sizeof(Player));
+    for (int i = 0; i < game->playerCount; i++) {
+        epoll_ctl(server->lobby, EPOLL_CTL_DEL, server->queue[i], NULL);
+        open_client(game, i, server->queue[i]);
+    }
+    server->queued -= game->playerCount;
+    memmove(server->queue, server->queue + game->playerCount, 
+            sizeof(int) * server->queued);
+
+    // Seating is timed as a turn would be, until the first game starts.
+    game->turn = (Turn) {.asked = true, .reported = false};
+    clock_gettime(CLOCK_MONOTONIC, &game->turn.askedAt);
+
+    Deck deck;
+    int status = ERROR_DECK;
+    if (deck_at(server->decks, 0, server->buffer, &deck)) {
+        game->deck = deck.cards;
+        game->deckSize = deck.size;
+        status = seat_players(table);
+    }
+    if (status != NORMAL_EXIT) {
+        end_table(table, status);
+    }
+}
+
+/**
+ * Tell each player at a table its seat, as the command line would tell a 
+ * player process, and deal the first hands. The table then waits for 
+ * every player to accept.
+ * 
+ * @param table - The table to seat.
+ * @return The error encountered, otherwise NORMAL_EXIT.
+ */ 
+int seat_players(Table* table) {
+    HubInfo* game = &table->game;
+    int status = deal_cards(game);
+    if (status != NORMAL_EXIT) {
+        return status;
+    }
+
+    for (int i = 0; i < game->playerCount; i++) {
+        send_seat(game, i);
+        send_hand(game, i);
+    }
+    return NORMAL_EXIT;
+}
+
+/**
+ * Initialise a player connected to a socket.
+ * 
+ * @param game - Information about the game state.
+ * @param playerNum - The seat of the player.
+ * @param client - The players socket.
+ */ 
+void open_client(HubInfo* game, int playerNum, int client) {
+    Player* player = &game->players[playerNum];
+    *player = (Player) {.hand = NULL, .track = -1, .local = NULL,
+            .binary = false, .shared = false, .mailbox = NULL};
+
+    // Epoll watches each descriptor once, so the socket is written 
+    // through a copy.
+    open_channel(&player->read, game->events, client, CHANNEL_READ, 
+            playerNum);
+    open_channel(&player->write, game->events, dup(client), 
+            CHANNEL_WRITE, playerNum);
+    // Players keep their stderr to themselves.
+    player->error = (Channel) {.kind = CHANNEL_ERROR, .player = playerNum, 
+            .closed = true, .loop = game->events};
+}
+
+/**
+ * Carry a table on as far as it can go after one of its sockets was 
+ * ready.
+ * 
+ * @param table - The table to carry on.
+ */ 
+void resume_table(Table* table) {
+    HubInfo* game = &table->game;
+    switch (table->state) {
+        case TABLE_SEATING:
+            // Await only once nothing is left to wait for.
+            if (unready_seat(table)) {
+                return;
+            }
+            for (int i = 0; i < game->playerCount; i++) {
+                if (!await_player(game, i)) {
+                    end_table(table, ERROR_PLAYER);
+                    return;
+                }
+            }
+            table->state = TABLE_PLAYING;
+            start_game(game);
+            advance_table(table);
+            break;
+        case TABLE_PLAYING:
+            advance_table(table);
+            break;
+        case TABLE_FINISHING:
+            for (int i = 0; i < game->playerCount; i++) {
+                Channel* write = &game->players[i].write;
+                if (!write->closed && write->buffer.length) {
+                    return;
+                }
+            }
+            close_table(table);
+            break;
+    }
+}
+
+/**
+ * Find a player at a table that has not yet answered its seat.
+ * 
+ * @param table - The table being seated.
+ * @return The read channel of the first such player, or NULL if there 
+ *      are none.
+ */ 
+Channel* unready_seat(Table* table) {
+    for (int i = 0; i < table->game.playerCount; i++) {
+        Channel* read = &table->game.players[i].read;
+        if (!read->buffer.length && !read->closed) {
+            return read;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Play the games at a table on until one waits on a player. Tables stop 
+ * between games once every deck is played or the server is asked to stop.
+ * 
+ * @param table - The table to play.
+ */ 
+void advance_table(Table* table) {
+    Server* server = table->server;
+    HubInfo* game = &table->game;
+    int status;
+
+    while ((status = advance_game(game)) == NORMAL_EXIT) {
+        Deck deck;
+        game->games++;
+        if (stopRequested || game->games == server->decks->count) {
+            break;
+        } else if (!deck_at(server->decks, game->games, server->buffer, 
+                &deck)) {
+            status = ERROR_DECK;
+            break;
+        }
+        game->deck = deck.cards;
+        game->deckSize = deck.size;
+        // Players are reset between games.
+        if ((status = new_game(game)) != NORMAL_EXIT) {
+            break;
+        }
+        start_game(game);
+    }
+    if (status != GAME_WAITING) {
+        end_table(table, status);
+    }
+}
+
+/**
+ * End the players at a table and report how it did. The table closes once 
+ * its players have read GAMEOVER, or have had long enough to.
+ * 
+ * @param table - The table to end.
+ * @param status - The error the table ended with, otherwise NORMAL_EXIT.
+ */ 
+void end_table(Table* table, int status) {
+    table->state = TABLE_FINISHING;
+    clock_gettime(CLOCK_MONOTONIC, &table->finishedAt);
+    end_players(&table->game);
+    output_table(table, status);
+    resume_table(table);
+}
+
+/**
+ * Disconnect the players at a table and count its games. The table and 
+ * its players are freed once the server has finished with the events of 
+ * its sockets.
+ * 
+ * @param table - The table to close.
+ */ 
+void close_table(Table* table) {
+    Server* server = table->server;
+    HubInfo* game = &table->game;
+    for (int i = 0; i < game->playerCount; i++) {
+        close_channel(&game->players[i].read);
+        close_channel(&game->players[i].write);
+    }
+    table->state = TABLE_CLOSED;
+    server->games += game->games;
+
+    server->live[table->index] = server->live[--server->liveCount];
+    server->live[table->index]->index = table->index;
+    table->next = server->closed;
+    server->closed = table;
+}
+
+/**
+ * Free a closed table and its players.
+ * 
+ * @param table - The table to free.
+ */ 
+void free_table(Table* table) {
+    for (int i = 0; i < table->game.playerCount; i++) {
+        free(table->game.players[i].hand);
+    }
+    free(table->game.players);
+    free(table);
+}
+
+/**
+ * Output the games a table played and how each seat did, or why it ended 
+ * early.
+ * 
+ * @param table - The finished table.
+ * @param status - The error the table ended with, otherwise NORMAL_EXIT.
+ */ 
+void output_table(Table* table, int status) {
+    HubInfo* game = &table->game;
+    printf("Table=%d Games=%d ", table->id, game->games);
+    if (status != NORMAL_EXIT) {
+        fputs(error_message(status), stdout);
+    } else {
+        printf("Totals=");
+        for (int i = 0; i < game->playerCount; i++) {
+            printf(i ? " %d:%ld" : "%d:%ld", i, 
+                    game->players[i].totalScore);
+        }
+        printf(" Wins=");
+        for (int i = 0; i < game->playerCount; i++) {
+            printf(i ? " %d:%d" : "%d:%d", i, game->players[i].wins);
+        }
+        printf("\n");
+    }
+    fflush(stdout);
+}
@@ -0,0 +1,116 @@
+#ifndef _SERVER_H_
+#define _SERVER_H_
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "2310hub.h"
+
+#define SERVE_ARGS 4
+#define TABLE_DRAIN_MILLIS 1000
+#define SWEEP_MILLIS 100
+
+#define TABLE_SEATING 0
+#define TABLE_PLAYING 1
+#define TABLE_FINISHING 2
+#define TABLE_CLOSED 3
+
+/* Set once SIGINT or SIGTERM asks the server to stop. */
+extern volatile sig_atomic_t stopRequested;
+
+struct Table;
+
+/**
+ * A long running hub that seats players connecting to a Unix domain 
+ * socket at tables, in the order they connect. Every table is played on 
+ * one thread: each game is put down whenever it waits on a player and 
+ * picked up again once that players socket is ready, so a player that 
+ * stalls or misbehaves only holds up its own table.
+ * 
+ * @param game - The threshold, seats and protocol of every table
+ * @param decks - The decks every table plays, one game each
+ * @param buffer - Room for deck_at to hand out a deck in
+ * @param stallMillis - Report players slower than this, or NO_STALL
+ * @param listener - The socket players connect to, or -1 once the server 
+ *      has stopped seating players
+ * @param lobby - Watches the listener and the players waiting for a seat
+ * @param epoll - Watches the lobby and the sockets of every seated player
+ * @param queue - Players waiting for a seat, oldest first
+ * @param queued - The number of players waiting
+ * @param capacity - The room in the queue
+ * @param live - The tables that have not closed
+ * @param liveCount - The number of tables that have not closed
+ * @param room - The room for live tables
+ * @param closed - Tables closed since they were last freed
+ * @param tables - The tables seated so far
+ * @param games - The games finished by every table
+ * @param swept - When the tables were last checked on
+ */ 
+typedef struct {
+    HubInfo* game;
+    DeckSet* decks;
+    unsigned char* buffer;
+    int stallMillis;
+    int listener;
+    int lobby;
+    int epoll;
+    int* queue;
+    int queued;
+    int capacity;
+    struct Table** live;
+    int liveCount;
+    int room;
+    struct Table* closed;
+    int tables;
+    long games;
+    struct timespec swept;
+} Server;
+
+/**
+ * A table of connected players with its own copy of the game state. Its 
+ * event loop shares the servers epoll instance and has the table as its 
+ * context, so the table of any ready socket can be found.
+ * 
+ * @param server - The server that seated the table
+ * @param id - The order the table was seated in
+ * @param index - Where the table is among the live tables
+ * @param state - TABLE_SEATING, TABLE_PLAYING, TABLE_FINISHING or 
+ *      TABLE_CLOSED
+ * @param game - The game the table plays
+ * @param events - The event loop the tables sockets are watched by
+ * @param finishedAt - When the table ended its players
+ * @param next - The next closed table
+ */ 
+typedef struct Table {
+    Server* server;
+    int id;
+    int index;
+    int state;
+    HubInfo game;
+    EventLoop events;
+    struct timespec finishedAt;
+    struct Table* next;
+} Table;
+
+/* Serving */
+void run_server(HubInfo* game, char** argv, const HubOptions* options);
+int open_listener(const char* path);
+void serve_lobby(Server* server);
+void accept_players(Server* server);
+void drop_player(Server* server, int client);
+void close_lobby(Server* server, const char* path);
+void sweep_tables(Server* server);
+void request_stop(int sig);
+
+/* Tables */
+void open_table(Server* server);
+int seat_players(Table* table);
+void open_client(HubInfo* game, int playerNum, int client);
+void resume_table(Table* table);
+Channel* unready_seat(Table* table);
+void advance_table(Table* table);
+void end_table(Table* table, int status);
+void close_table(Table* table);
+void free_table(Table* table);
+void output_table(Table* table, int status);
+
+#endif // _SERVER_H_
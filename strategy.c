@@ -0,0 +1,119 @@
+#include "rules.h"
+
+/**
+ * Find the Card for alice to play
+ * 
+ * @param specialMove - Does the player have a special move
+ * @param isLead - If the player is the lead
+ * @param game - information about the game state.
+ * @return Card - The card to be played.
+ */ 
+Card alice_play_card(PlayerInfo* game, bool isLead, Card lead, 
+        bool specialMove) {
+    return play_table(&aliceTable, game->hand, isLead, lead, specialMove);
+}
+
+/**
+ * Find the Card for bob to play
+ * 
+ * @param specialMove - Does the player have a special move
+ * @param isLead - If the player is the lead
+ * @param game - information about the game state.
+ * @return Card - The card to be played.
+ */ 
+Card bob_play_card(PlayerInfo* game, bool isLead, Card lead, 
+        bool specialMove) {
+    return play_table(&bobTable, game->hand, isLead, lead, specialMove);
+}
+
+/**
+ * Find the Card to play for a strategy read from a description.
+ * 
+ * @param specialMove - Does the player have a special move
+ * @param isLead - If the player is the lead
+ * @param game - information about the game state, with its table.
+ * @return Card - The card to be played.
+ */ 
+Card table_play_card(PlayerInfo* game, bool isLead, Card lead, 
+        bool specialMove) {
+    return play_table(game->table, game->hand, isLead, lead, specialMove);
+}
+
+/**
+ * Choose a card by looking up the rule for the situation, so each suit 
+ * of the order costs a single bit scan of the hand.
+ * 
+ * @param table - The strategy.
+ * @param hand - The cards held.
+ * @param isLead - If the player is the lead.
+ * @param lead - The first card played this round.
+ * @param specialMove - Does the player have a special move.
+ * @return The card to play, or a DORMANT_CHAR card if the hand is empty.
+ */ 
+Card play_table(const StrategyTable* table, const Hand* hand, bool isLead, 
+        Card lead, bool specialMove) {
+    Card toPlay = (Card) {.suit = DORMANT_CHAR, .rank = DORMANT_CHAR};
+    int leadSuit = isLead ? -1 : suit_index(lead.suit);
+    Situation situation = isLead ? SITUATION_LEAD 
+            : (leadSuit != -1 && hand->suits[leadSuit]) ? SITUATION_FOLLOW 
+            : SITUATION_DISCARD;
+    const Rule* rule = &table->rules[situation][specialMove];
+
+    for (int i = 0; i < rule->count; i++) {
+        int suit = (rule->suits[i] == FOLLOW_SUIT) ? leadSuit : rule->suits[i];
+        if (suit != -1 && (rule->highest 
+                ? highest_card(hand, SUITS[suit], &toPlay) 
+                : lowest_card(hand, SUITS[suit], &toPlay))) {
+            break;
+        }
+    }
+    return toPlay;
+}
+
+/**
+ * Look up a strategy that can run inside the hub.
+ * 
+ * @param name - A player argument, either builtin:<name>, a plugin ending 
+ *      in .so which exports play_card or a description ending in .strat.
+ * @param strategy - Set to the strategy, with a NULL play function if it 
+ *      could not be loaded.
+ * @return Whether the name refers to an in-process strategy at all.
+ */ 
+bool find_strategy(const char* name, Strategy* strategy) {
+    const struct {
+        const char* name;
+        Strategy strategy;
+    } builtins[] = {{"alice", {table_play_card, &aliceTable}}, 
+            {"bob", {table_play_card, &bobTable}}};
+    int length = strlen(name);
+    *strategy = (Strategy) {.play = NULL, .table = NULL};
+
+    if (!strncmp(name, BUILTIN_PREFIX, strlen(BUILTIN_PREFIX))) {
+        name += strlen(BUILTIN_PREFIX);
+        for (int i = 0; i < sizeof(builtins) / sizeof(builtins[0]); i++) {
+            if (!strcmp(name, builtins[i].name)) {
+                *strategy = builtins[i].strategy;
+            }
+        }
+        return true;
+    } else if (length > strlen(PLUGIN_SUFFIX) && !strcmp(name + length 
+            - strlen(PLUGIN_SUFFIX), PLUGIN_SUFFIX)) {
+        // Plugins stay loaded for the lifetime of the hub.
+        void* plugin = dlopen(name, RTLD_NOW | RTLD_LOCAL);
+        if (plugin) {
+            *(void**) &strategy->play = dlsym(plugin, PLUGIN_SYMBOL);
+        }
+        return true;
+    } else if (length > strlen(TABLE_SUFFIX) && !strcmp(name + length 
+            - strlen(TABLE_SUFFIX), TABLE_SUFFIX)) {
+        // Tables stay loaded for the lifetime of the hub.
+        StrategyTable* table = malloc(sizeof(StrategyTable));
+        if (read_table(name, table)) {
+            *strategy = (Strategy) {.play = table_play_card, .table = table};
+        } else {
+            free(table);
+        }
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,129 @@
+#ifndef _STRATEGY_H_
+#define _STRATEGY_H_
+
+#include <dlfcn.h>
+#include "ring.h"
+
+#define DORMANT_CHAR '!'
+
+#define BUILTIN_PREFIX "builtin:"
+#define PLUGIN_SUFFIX ".so"
+#define PLUGIN_SYMBOL "play_card"
+#define TABLE_SUFFIX ".strat"
+
+#define RULE_LEAD "lead"
+#define RULE_FOLLOW "follow"
+#define RULE_DISCARD "discard"
+#define RULE_SPECIAL "special"
+#define RULE_HIGHEST "max"
+#define RULE_LOWEST "min"
+#define RULE_COMMENT '#'
+#define LEAD_SUIT 'L'
+#define FOLLOW_SUIT -1
+
+/**
+ * The situations a strategy chooses a card in.
+ */ 
+typedef enum {
+    SITUATION_LEAD,
+    SITUATION_FOLLOW,
+    SITUATION_DISCARD,
+    SITUATION_COUNT
+} Situation;
+
+/**
+ * How to choose a card in one situation: the first suit in order that the 
+ * hand holds, then its highest or lowest card.
+ * 
+ * @param suits - Indices into SUITS, or FOLLOW_SUIT for the suit led
+ * @param count - The number of suits in the order
+ * @param highest - Whether to play the highest card rather than the lowest
+ */ 
+typedef struct {
+    int suits[SUIT_COUNT];
+    int count;
+    bool highest;
+} Rule;
+
+/**
+ * A strategy as a lookup table, with a rule for each situation with and 
+ * without a special move. Tables are compiled from a description with a 
+ * line for each rule:
+ *      lead|follow|discard [special] ORDER max|min
+ * where ORDER lists suits from SUITS or LEAD_SUIT. A player follows when 
+ * it holds the suit led and discards when it doesn't. Special rules 
+ * default to the ordinary rule of their situation.
+ * 
+ * @param rules - The rule for each situation, then for no special move 
+ *      and a special move
+ */ 
+typedef struct {
+    Rule rules[SITUATION_COUNT][2];
+} StrategyTable;
+
+/**
+ * Representation of a player.
+ * 
+ * @param hand - The cards held
+ * @param handSize - The number of cards
+ * @param score - rounds won by the player
+ * @param specialCards - D cards won by the player
+ * @param playerCount - The number of players
+ * @param threshold - The number of D cards needed for an additional score
+ * @param playCard - A function to select a card from the players hand
+ * @param table - The table playCard follows, if it is table_play_card
+ * @param binary - Whether the player process uses the binary protocol
+ * @param input - The player process reading from the hub
+ * @param ring - The ring the player process reads broadcasts from, or NULL
+ * @param mailbox - Where the player process takes turns, or NULL to use 
+ *      its pipes
+ */ 
+typedef struct PlayerInfo {
+    int score;
+    int specialCards;
+    int playerCount;
+    int playerNum;
+    int threshold;
+    int handSize;
+    Hand* hand;
+    Card (*playCard)(struct PlayerInfo*, bool, Card, bool);
+    const StrategyTable* table;
+    bool binary;
+    LineReader input;
+    Ring* ring;
+    Mailbox* mailbox;
+} PlayerInfo;
+
+/* The shipped strategies, which 2310tables generates from their .strat. */
+extern const StrategyTable aliceTable;
+extern const StrategyTable bobTable;
+
+/**
+ * A function choosing the card to play. It must not remove the card from 
+ * the hand or communicate with the hub, so that it can run in any process.
+ */ 
+typedef Card (*PlayCard)(struct PlayerInfo*, bool, Card, bool);
+
+/**
+ * A strategy that can run inside the hub.
+ * 
+ * @param play - The function choosing the card to play
+ * @param table - The table play follows, NULL unless it is table_play_card
+ */ 
+typedef struct {
+    PlayCard play;
+    const StrategyTable* table;
+} Strategy;
+
+/* Strategies */
+Card alice_play_card(PlayerInfo* game, bool isLead, Card lead, 
+        bool specialMove);
+Card bob_play_card(PlayerInfo* game, bool isLead, Card lead, 
+        bool specialMove);
+Card table_play_card(PlayerInfo* game, bool isLead, Card lead, 
+        bool specialMove);
+Card play_table(const StrategyTable* table, const Hand* hand, bool isLead, 
+        Card lead, bool specialMove);
+bool find_strategy(const char* name, Strategy* strategy);
+
+#endif // _STRATEGY_H_
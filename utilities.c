@@ -1,24 +1,63 @@
 #include "utilities.h"
 
+/* The values of suits and ranks, as encode_card packs them but one more
+ * for suits, and zero for any other byte. */
+static const char suitValues[UCHAR_MAX + 1] = {['D'] = 1, ['H'] = 2, 
+        ['C'] = 3, ['S'] = 4};
+static const char rankValues[UCHAR_MAX + 1] = {['1'] = 1, ['2'] = 2, 
+        ['3'] = 3, ['4'] = 4, ['5'] = 5, ['6'] = 6, ['7'] = 7, ['8'] = 8, 
+        ['9'] = 9, ['a'] = 10, ['b'] = 11, ['c'] = 12, ['d'] = 13, 
+        ['e'] = 14, ['f'] = 15};
+
+/* The bytes strtol skips before a number. */
+static const bool spaces[UCHAR_MAX + 1] = {[' '] = true, ['\t'] = true, 
+        ['\n'] = true, ['\v'] = true, ['\f'] = true, ['\r'] = true};
+
+/* The bytes fields are split on. NEWROUND has always been split on the
+ * letters of the command, as strtok was given it, so they end its number 
+ * too. */
+static const bool commas[UCHAR_MAX + 1] = {[','] = true};
+static const bool roundLetters[UCHAR_MAX + 1] = {['N'] = true, 
+        ['E'] = true, ['W'] = true, ['R'] = true, ['O'] = true, 
+        ['U'] = true, ['D'] = true};
+
+/* The command a line could be by its first byte, the text of each command,
+ * and the command to try next once a line stops matching one. Each 
+ * alternative shares the text matched so far. */
+static const MessageType openers[UCHAR_MAX + 1] = {
+        ['N'] = MESSAGE_NEWROUND, ['P'] = MESSAGE_PLAYED, 
+        ['G'] = MESSAGE_GAMEOVER, ['H'] = MESSAGE_HAND, 
+        ['S'] = MESSAGE_SEAT};
+static const char* const commands[] = {[MESSAGE_INVALID] = "", 
+        [MESSAGE_NEWROUND] = RECIEVE_NEWROUND, 
+        [MESSAGE_PLAYED] = RECIEVE_PLAYED, 
+        [MESSAGE_GAMEOVER] = RECIEVE_GAMEOVER, 
+        [MESSAGE_NEWGAME] = RECIEVE_NEWGAME, [MESSAGE_HAND] = RECIEVE_HAND, 
+        [MESSAGE_PLAY] = SEND_PLAY, [MESSAGE_WAKE] = "", 
+        [MESSAGE_SEAT] = RECIEVE_SEAT};
+static const MessageType alternatives[MESSAGE_SEAT + 1] = {
+        [MESSAGE_NEWROUND] = MESSAGE_NEWGAME, 
+        [MESSAGE_PLAYED] = MESSAGE_PLAY};
+
 /* Check if a command has been included in a string
  * 
  * @param line The string to search for the command in
  * @param toCheck The command to check for.
  * @param lengthMatch whether or not the string lengths must be the same
- */
+ */ 
 int check_command(char* line, char* toCheck, bool lengthMatch) {
     if (lengthMatch) {
         // Trim down the line.
         line += strlen(line) - strlen(toCheck);
-    }  
+    }
     return strncmp(line, toCheck, strlen(toCheck));
 }
 
 /* Convert an integer into a string.
- *
+ * 
  * @param num - The number to stringify.
  * @param line - The line to store a string in.
- */
+ */ 
 char* string_of(int num, char** line) {
     int length = 1;
     // Calculate the number of digits.
@@ -32,96 +71,668 @@ char* string_of(int num, char** line) {
 
 /* Convert some characters into an integer.
  * Returns -1 if this fails.
- *
+ * 
  * @param line - The characters to turn into an integer.
- */
+ */ 
 int read_int(char* line) {
-    if (line == NULL) {
-        return -1;
+    return line ? scan_int(line, strlen(line)) : -1;
+}
+
+/**
+ * Read a number from some text exactly as strtol would, then require 
+ * that nothing is left over. Out of range numbers are clamped to a long 
+ * and then cut down to an int, as they always have been.
+ * 
+ * @param text - The text, which need not end in a null.
+ * @param length - The length of the text.
+ * @return The number, or -1 if the text is not one. Empty text is 0.
+ */ 
+int scan_int(const char* text, int length) {
+    const char* end = text + length;
+    const char* digit = text;
+    while (digit < end && spaces[(unsigned char) *digit]) {
+        digit++;
+    }
+    bool negative = digit < end && *digit == '-';
+    digit += digit < end && (*digit == '-' || *digit == '+');
+    if (digit == end || *digit < '0' || *digit > '9') {
+        // Nothing is read, so everything is left over.
+        return length ? -1 : 0;
+    }
+
+    unsigned long limit = negative ? (unsigned long) LONG_MAX + 1 : LONG_MAX;
+    unsigned long value = 0;
+    for (; digit < end && *digit >= '0' && *digit <= '9'; digit++) {
+        int next = *digit - '0';
+        value = (value > (limit - next) / BASE) ? limit 
+                : value * BASE + next;
     }
-    char* error;
-    int num;
-    num = strtol(line, &error, BASE);
-    if (strlen(error) > 0) {
-        // Any non-integer characters read
+    if (digit != end) {
         return -1;
     }
-    return num;
+    return (int) (negative ? (long) -value : (long) value);
 }
 
-/* Read a line of text
- *
+/* Read a line of text. New code should use a LineReader, which doesn't
+ * allocate for every line.
+ * 
  * @param f The stream to read from
- * @param line A variable to save to
+ * @param line A variable to save to, which the caller must free
  * @return The line that is read
- */
+ */ 
 char* read_line(FILE* toRead, char** line) {
-    int c;
-    int lineL = 0;
-    int charCount = CHAR_BUFFER;
-    *line = malloc(sizeof(char) * charCount);
-    while ((c = fgetc(toRead)) != '\n') {
-        // Handle EOF seperately to \n
-        if (c == EOF) {
-            free(*line);  
-            return NULL;
+    size_t charCount = 0;
+    *line = NULL;
+    ssize_t lineL = getline(line, &charCount, toRead);
+
+    // Handle EOF seperately to \n, including a line cut short by it.
+    if (lineL <= 0 || (*line)[lineL - 1] != '\n') {
+        free(*line);
+        return NULL;
+    }
+    (*line)[lineL - 1] = '\0';
+    return *line;
+}
+
+/**
+ * Start reading a file descriptor.
+ * 
+ * @param reader - The reader to initialise.
+ * @param fd - The file descriptor to read.
+ */ 
+void init_reader(LineReader* reader, int fd) {
+    *reader = (LineReader) {.fd = fd, .data = malloc(READER_BUFFER),
+            .start = 0, .length = 0, .capacity = READER_BUFFER, 
+            .eof = false};
+}
+
+/**
+ * Release a readers buffer. The file descriptor is left open.
+ * 
+ * @param reader - The reader to free.
+ */ 
+void free_reader(LineReader* reader) {
+    free(reader->data);
+    reader->data = NULL;
+}
+
+/**
+ * Make one read into the end of the buffer, making room first. Anything 
+ * handed out before is no longer valid.
+ * 
+ * @param reader - The reader to fill.
+ * @return The bytes read, 0 at the end of the file or -1 on error.
+ */ 
+int fill_reader(LineReader* reader) {
+    if (reader->start + reader->length == reader->capacity) {
+        if (reader->start > 0) {
+            memmove(reader->data, reader->data + reader->start, 
+                    reader->length);
+            reader->start = 0;
+        } else {
+            reader->capacity *= 2;
+            reader->data = realloc(reader->data, reader->capacity);
         }
-        (*line)[lineL++] = c;
-        // Check if more memory is needed.
-        if (lineL + 1 >= charCount) {
-            charCount *= 2;
-            *line = realloc(*line, sizeof(char) * charCount);
+    }
+    int got = read(reader->fd, reader->data + reader->start 
+            + reader->length, reader->capacity - reader->start 
+            - reader->length);
+    if (got > 0) {
+        reader->length += got;
+    } else if (got == 0) {
+        reader->eof = true;
+    }
+    return got;
+}
+
+/**
+ * Hand out the next line already in the buffer without reading.
+ * 
+ * @param reader - The reader to take from.
+ * @return The line without its newline, valid until the reader is next 
+ *      filled, or NULL if no whole line is buffered.
+ */ 
+char* take_line(LineReader* reader) {
+    char* line = reader->data + reader->start;
+    char* end = memchr(line, '\n', reader->length);
+    if (!end) {
+        return NULL;
+    }
+    *end = '\0';
+    reader->start += end + 1 - line;
+    reader->length -= end + 1 - line;
+    return line;
+}
+
+/**
+ * Hand out a number of bytes already in the buffer without reading.
+ * 
+ * @param reader - The reader to take from.
+ * @param count - The number of bytes wanted.
+ * @return The bytes, valid until the reader is next filled, or NULL if 
+ *      fewer are buffered.
+ */ 
+char* take_bytes(LineReader* reader, int count) {
+    if (reader->length < count) {
+        return NULL;
+    }
+    reader->start += count;
+    reader->length -= count;
+    return reader->data + reader->start - count;
+}
+
+/**
+ * Read the next line, blocking until it arrives.
+ * 
+ * @param reader - The reader to take from.
+ * @return The line without its newline, valid until the reader is next 
+ *      used, or NULL if the file ends first.
+ */ 
+char* next_line(LineReader* reader) {
+    char* line;
+    while (!(line = take_line(reader))) {
+        if (reader->eof 
+                || (fill_reader(reader) < 0 && errno != EINTR)) {
+            return NULL;
         }
     }
-    (*line)[lineL] = '\0';
-    return *line;
+    return line;
 }
 
 /* Check if a card is valid
- *
+ * 
  * @param card A playing card to check
- */
+ */ 
 bool check_card(char* card) {
-    if (strlen(card) != 2 || (card[0] != 'D' && card[0] != 'H' 
-            && card[0] != 'C' && card[0] != 'S') 
-            || (card[1] < '1' || (card[1] > '9' 
-            && card[1] < 'a') || card[1] > 'f')) {
+    Card unused;
+    return card_at(card, &unused) && !card[2];
+}
+
+/**
+ * Read a card from the start of some text, without looking past a null.
+ * 
+ * @param text - The text.
+ * @param card - Set to the card, if there is one.
+ * @return Whether the text starts with a valid suit and rank.
+ */ 
+bool card_at(const char* text, Card* card) {
+    if (!suitValues[(unsigned char) text[0]] 
+            || !rankValues[(unsigned char) text[1]]) {
+        return false;
+    }
+    *card = (Card) {.suit = text[0], .rank = text[1]};
+    return true;
+}
+
+/**
+ * Find where a suit is in SUITS.
+ * 
+ * @param suit - A letter suit.
+ * @return The index of the suit, or -1 if it is not a suit.
+ */ 
+int suit_index(char suit) {
+    const char* found = suit ? strchr(SUITS, suit) : NULL;
+    return found ? found - SUITS : -1;
+}
+
+/**
+ * Find the value of a rank, as encode_card packs it.
+ * 
+ * @param rank - A hexadecimal rank.
+ * @return The value from 1 to f, or -1 if it is not a rank.
+ */ 
+int rank_index(char rank) {
+    if (rank >= '1' && rank <= '9') {
+        return rank - '0';
+    } else if (rank >= 'a' && rank <= 'f') {
+        return rank - 'a' + BASE;
+    }
+    return -1;
+}
+
+/**
+ * Make a hand holding exactly the given cards.
+ * 
+ * @param hand - The hand to fill.
+ * @param cards - An array of valid cards.
+ * @param count - The number of cards.
+ */ 
+void fill_hand(Hand* hand, const Card* cards, int count) {
+    memset(hand, 0, sizeof(Hand));
+    for (int i = 0; i < count; i++) {
+        add_card(hand, cards[i]);
+    }
+}
+
+/**
+ * Add a valid card to a hand.
+ * 
+ * @param hand - The hand to add to.
+ * @param card - The card to add.
+ */ 
+void add_card(Hand* hand, Card card) {
+    int suit = suit_index(card.suit);
+    int rank = rank_index(card.rank);
+    hand->counts[suit][rank]++;
+    hand->suits[suit] |= 1 << rank;
+}
+
+/**
+ * Take one copy of a card out of a hand.
+ * 
+ * @param hand - The hand to remove from.
+ * @param card - The card to remove.
+ * @return Whether the hand held the card.
+ */ 
+bool remove_card(Hand* hand, Card card) {
+    int suit = suit_index(card.suit);
+    int rank = rank_index(card.rank);
+    if (suit == -1 || rank == -1 || hand->counts[suit][rank] == 0) {
         return false;
     }
+    if (--hand->counts[suit][rank] == 0) {
+        hand->suits[suit] &= ~(1 << rank);
+    }
+    return true;
+}
+
+/**
+ * Find the highest card of a suit in a hand.
+ * 
+ * @param hand - The hand to search.
+ * @param suit - The suit wanted.
+ * @param card - Set to the card if there is one.
+ * @return Whether the hand holds any card of the suit.
+ */ 
+bool highest_card(const Hand* hand, char suit, Card* card) {
+    int index = suit_index(suit);
+    if (index == -1 || !hand->suits[index]) {
+        return false;
+    }
+    int rank = sizeof(unsigned int) * 8 - 1 
+            - __builtin_clz(hand->suits[index]);
+    return decode_card(index << 4 | rank, card);
+}
+
+/**
+ * Find the lowest card of a suit in a hand.
+ * 
+ * @param hand - The hand to search.
+ * @param suit - The suit wanted.
+ * @param card - Set to the card if there is one.
+ * @return Whether the hand holds any card of the suit.
+ */ 
+bool lowest_card(const Hand* hand, char suit, Card* card) {
+    int index = suit_index(suit);
+    if (index == -1 || !hand->suits[index]) {
+        return false;
+    }
+    return decode_card(index << 4 | __builtin_ctz(hand->suits[index]), 
+            card);
+}
+
+/**
+ * Write a message from the hub in the text protocol. HAND is not handled 
+ * since it has no fixed size.
+ * 
+ * @param message - The message to write.
+ * @param buffer - Where to write the text.
+ * @param size - The size of the buffer.
+ * @return The length of the text, as snprintf.
+ */ 
+int format_message(const Message* message, char* buffer, int size) {
+    switch (message->type) {
+        case MESSAGE_NEWROUND:
+            return snprintf(buffer, size, "%s%d\n", RECIEVE_NEWROUND, 
+                    message->player);
+        case MESSAGE_PLAYED:
+            return snprintf(buffer, size, "%s%d,%c%c\n", RECIEVE_PLAYED, 
+                    message->player, message->card.suit, message->card.rank);
+        case MESSAGE_NEWGAME:
+            return snprintf(buffer, size, "%s%d\n", RECIEVE_NEWGAME, 
+                    message->count);
+        case MESSAGE_PLAY:
+            return snprintf(buffer, size, "%s%c%c\n", SEND_PLAY, 
+                    message->card.suit, message->card.rank);
+        default:
+            return snprintf(buffer, size, "%s\n", RECIEVE_GAMEOVER);
+    }
+}
+
+/**
+ * Parse a line of the text protocol in one pass, without changing it. 
+ * The command is found through lookup tables, then its fields are split 
+ * and checked as they are reached. Numbers are read as read_int would, so 
+ * callers check their range, and the hand size of HAND against their own. 
+ * The cards of HAND are allocated and must be freed by the caller.
+ * 
+ * @param line - The line, without its newline.
+ * @param message - Set to the message, if the line is valid.
+ * @return The type of message, or MESSAGE_INVALID.
+ */ 
+MessageType parse_text(const char* line, Message* message) {
+    MessageType type = openers[(unsigned char) line[0]];
+    int matched;
+    while (type != MESSAGE_INVALID) {
+        const char* command = commands[type];
+        matched = 0;
+        while (command[matched] && line[matched] == command[matched]) {
+            matched++;
+        }
+        if (!command[matched]) {
+            break;
+        }
+        type = alternatives[type];
+    }
+
+    message->type = (type != MESSAGE_INVALID 
+            && parse_fields(type, line + matched, message)) 
+            ? type : MESSAGE_INVALID;
+    return message->type;
+}
+
+/**
+ * Decode and check the fields following the command of a text message.
+ * 
+ * @param type - The command.
+ * @param text - The rest of the line.
+ * @param message - Where to put the fields.
+ * @return Whether the fields were valid.
+ */ 
+bool parse_fields(MessageType type, const char* text, Message* message) {
+    const char* field;
+    int length;
+    int* seat[EXPECTED_ARGS] = {&message->players, &message->player, 
+            &message->threshold, &message->count};
+    switch (type) {
+        case MESSAGE_GAMEOVER:
+            return !*text;
+        case MESSAGE_NEWGAME:
+            message->count = scan_int(text, strlen(text));
+            return true;
+        case MESSAGE_NEWROUND:
+            field = next_field(&text, roundLetters, &length);
+            message->player = field ? scan_int(field, length) : -1;
+            return true;
+        case MESSAGE_PLAY:
+            return card_at(text, &message->card) && !text[2];
+        case MESSAGE_PLAYED:
+            field = next_field(&text, commas, &length);
+            message->player = field ? scan_int(field, length) : -1;
+            // Anything after the card is ignored.
+            field = next_field(&text, commas, &length);
+            return field && length == 2 && card_at(field, &message->card);
+        case MESSAGE_HAND:
+            field = next_field(&text, commas, &length);
+            message->count = field ? scan_int(field, length) : -1;
+            break;
+        case MESSAGE_SEAT:
+            return parse_seat(text, seat, &message->protocol);
+        default:
+            return false;
+    }
+
+    // Each card takes at least three bytes, so a count that the line can't 
+    // hold is refused before anything is allocated.
+    if (message->count < 1 || message->count > strlen(text) / 3) {
+        return false;
+    }
+    message->cards = malloc(sizeof(Card) * message->count);
+    int cardCount = 0;
+    while ((field = next_field(&text, commas, &length))) {
+        if (cardCount == message->count || length != 2 
+                || !card_at(field, &message->cards[cardCount++])) {
+            free(message->cards);
+            return false;
+        }
+    }
+    if (cardCount < message->count) {
+        free(message->cards);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Decode the fields of SEAT. Unlike the other commands none may be empty, 
+ * so each has to start just past the comma ending the last, and nothing 
+ * may follow the protocol.
+ * 
+ * @param text - The fields.
+ * @param numbers - Set to the numbers of the seat, in order.
+ * @param protocol - Set to the protocol offered, or NULL if there is none.
+ * @return Whether the fields were valid.
+ */ 
+bool parse_seat(const char* text, int** numbers, const char** protocol) {
+    const char* field;
+    int length;
+    for (int i = 0; i < EXPECTED_ARGS; i++) {
+        const char* expected = text + (i > 0);
+        if ((field = next_field(&text, commas, &length)) != expected) {
+            return false;
+        }
+        *numbers[i] = scan_int(field, length);
+    }
+
+    *protocol = NULL;
+    if (*text) {
+        const char* expected = text + 1;
+        *protocol = next_field(&text, commas, &length);
+        return *protocol == expected && !*text;
+    }
     return true;
 }
 
 /**
- * Find a maximum of two ints.
+ * Find the next field of some text, as strtok would without changing it.
+ * 
+ * @param text - Where to start looking. Moved past the field.
+ * @param delimiters - The bytes fields are split on, indexed by byte.
+ * @param length - Set to the length of the field.
+ * @return The start of the field, or NULL if there are no more.
  */ 
-int find_max(int o1, int o2) {
-    return o1 > o2;
+const char* next_field(const char** text, const bool* delimiters, 
+        int* length) {
+    const char* start = *text;
+    while (*start && delimiters[(unsigned char) *start]) {
+        start++;
+    }
+    const char* end = start;
+    while (*end && !delimiters[(unsigned char) *end]) {
+        end++;
+    }
+    *text = end;
+    *length = end - start;
+    return (end > start) ? start : NULL;
 }
 
 /**
- * Find a minimum of two ints.
+ * Pack a card into a byte, the suit index above the rank.
+ * 
+ * @param card - A valid card.
  */ 
-int find_min(int o1, int o2) {
-    return o1 < o2;
+unsigned char encode_card(Card card) {
+    int rank = (card.rank <= '9') ? card.rank - '0' : card.rank - 'a' + BASE;
+    return (strchr(SUITS, card.suit) - SUITS) << 4 | rank;
 }
 
 /**
- * Shorten a hand if a card has been played
+ * Unpack a card from a byte, checking it is valid.
  * 
- * @param hand - An array of cards.
- * @param handSize - The number of cards in the hand.
- * @param Card - The card in the array to reduce.
- * @return Whether or not the hand was rotated.
+ * @param byte - A byte made by encode_card.
+ * @param card - Set to the card.
+ * @return Whether the byte held a valid card.
  */ 
-bool rotate_hand(Card* hand, int* handSize, Card played) {
-    // True if played matches a card in the hand
-    bool rotate = false;
-    for (int i = 0; i < *handSize; i++) {
-        if (hand[i].suit == played.suit && hand[i].rank == played.rank) {
-            rotate = true;
+bool decode_card(unsigned char byte, Card* card) {
+    int suit = byte >> 4;
+    int rank = byte & 0xf;
+    if (suit >= strlen(SUITS) || rank == 0) {
+        return false;
+    }
+    *card = (Card) {.suit = SUITS[suit],
+            .rank = (rank < BASE) ? '0' + rank : 'a' + rank - BASE};
+    return true;
+}
+
+/**
+ * Write a number seven bits per byte, low bits first.
+ * 
+ * @param buffer - Space for at least MAX_VARINT bytes.
+ * @param value - The number to write.
+ * @return The number of bytes written.
+ */ 
+int put_varint(unsigned char* buffer, unsigned int value) {
+    int length = 0;
+    while (value >= VARINT_MORE) {
+        buffer[length++] = (value & (VARINT_MORE - 1)) | VARINT_MORE;
+        value >>= VARINT_BITS;
+    }
+    buffer[length++] = value;
+    return length;
+}
+
+/**
+ * Read a number written by put_varint.
+ * 
+ * @param buffer - The bytes to read.
+ * @param length - The number of bytes available.
+ * @param value - Set to the number read.
+ * @return The bytes used, 0 if more are needed, or -1 if it is invalid.
+ */ 
+int get_varint(const unsigned char* buffer, int length, int* value) {
+    unsigned int result = 0;
+    for (int i = 0; i < length && i < MAX_VARINT; i++) {
+        result |= (unsigned int) (buffer[i] & (VARINT_MORE - 1))
+                << (VARINT_BITS * i);
+        if (!(buffer[i] & VARINT_MORE)) {
+            *value = result;
+            // Only non-negative ints are sent.
+            return (*value < 0) ? -1 : i + 1;
+        }
+    }
+    return (length >= MAX_VARINT) ? -1 : 0;
+}
+
+/**
+ * Find the number of bytes a message takes in the binary protocol.
+ * 
+ * @param message - The message to measure.
+ */ 
+int encoded_size(const Message* message) {
+    unsigned char varint[MAX_VARINT];
+    switch (message->type) {
+        case MESSAGE_NEWROUND:
+            return 1 + put_varint(varint, message->player);
+        case MESSAGE_PLAYED:
+            return 2 + put_varint(varint, message->player);
+        case MESSAGE_NEWGAME:
+            return 1 + put_varint(varint, message->count);
+        case MESSAGE_HAND:
+            return 1 + put_varint(varint, message->count) + message->count;
+        case MESSAGE_PLAY:
+            return 2;
+        default:
+            return 1;
+    }
+}
+
+/**
+ * Write a message in the binary protocol: an opcode byte, then any player 
+ * or count as a varint, then one byte per card.
+ * 
+ * @param message - The message to write.
+ * @param buffer - Space for encoded_size bytes.
+ * @return The number of bytes written.
+ */ 
+int encode_message(const Message* message, unsigned char* buffer) {
+    int length = 1;
+    buffer[0] = message->type;
+    switch (message->type) {
+        case MESSAGE_NEWROUND:
+            length += put_varint(buffer + length, message->player);
+            break;
+        case MESSAGE_PLAYED:
+            length += put_varint(buffer + length, message->player);
+            buffer[length++] = encode_card(message->card);
+            break;
+        case MESSAGE_NEWGAME:
+            length += put_varint(buffer + length, message->count);
+            break;
+        case MESSAGE_HAND:
+            length += put_varint(buffer + length, message->count);
+            for (int i = 0; i < message->count; i++) {
+                buffer[length++] = encode_card(message->cards[i]);
+            }
+            break;
+        case MESSAGE_PLAY:
+            buffer[length++] = encode_card(message->card);
+            break;
+        default:
+            break;
+    }
+    return length;
+}
+
+/**
+ * Read a message in the binary protocol. The cards of a HAND are 
+ * allocated and must be freed by the caller.
+ * 
+ * @param buffer - The bytes to read.
+ * @param length - The number of bytes available.
+ * @param message - Set to the message read.
+ * @return The bytes used, 0 if more are needed, or -1 if it is invalid.
+ */ 
+int decode_message(const unsigned char* buffer, int length, 
+        Message* message) {
+    int used = 1;
+    int got;
+    if (length < 1) {
+        return 0;
+    }
+    message->type = buffer[0];
+    switch (message->type) {
+        case MESSAGE_GAMEOVER:
+        case MESSAGE_WAKE:
+            return used;
+        case MESSAGE_PLAY:
+            if (length < 2) {
+                return 0;
+            }
+            return decode_card(buffer[1], &message->card) ? 2 : -1;
+        case MESSAGE_NEWROUND:
+        case MESSAGE_PLAYED:
+            got = get_varint(buffer + used, length - used, &message->player);
+            break;
+        case MESSAGE_NEWGAME:
+        case MESSAGE_HAND:
+            got = get_varint(buffer + used, length - used, &message->count);
+            break;
+        default:
+            return -1;
+    }
+    if (got <= 0) {
+        return got;
+    }
+    used += got;
+
+    if (message->type == MESSAGE_PLAYED) {
+        if (used >= length) {
+            return 0;
+        }
+        return decode_card(buffer[used], &message->card) ? used + 1 : -1;
+    } else if (message->type == MESSAGE_HAND) {
+        // Wait for the whole hand before allocating it.
+        if (used + message->count > length) {
+            return 0;
+        }
+        message->cards = malloc(sizeof(Card) * message->count);
+        for (int i = 0; i < message->count; i++) {
+            if (!decode_card(buffer[used + i], &message->cards[i])) {
+                free(message->cards);
+                return -1;
+            }
         }
-        hand[i] = (rotate && i < *handSize - 1) ? hand[i + 1] : hand[i];
+        used += message->count;
     }
-    (*handSize)--;
-    return rotate;
+    return used;
 }
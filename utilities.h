@@ -4,21 +4,47 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <limits.h>
 
 #define NORMAL_EXIT 0
 
 #define PLAYER_READY '@'
+#define PLAYER_READY_BINARY '#'
+#define PLAYER_READY_RING '$'
+#define PLAYER_READY_MAILBOX '&'
+#define PLAYER_WAITING '?'
 #define SPECIAL_SUIT 'D'
 
 #define RECIEVE_HAND "HAND"
 #define RECIEVE_NEWROUND "NEWROUND"
 #define RECIEVE_PLAYED "PLAYED"
 #define RECIEVE_GAMEOVER "GAMEOVER"
+#define RECIEVE_NEWGAME "NEWGAME"
+#define RECIEVE_SEAT "SEAT"
 #define SEND_PLAY "PLAY"
 
+#define PROTOCOL_VARIABLE "HUB_PROTOCOL"
+#define PROTOCOL_BINARY "binary"
+#define PROTOCOL_RING "ring"
+#define PROTOCOL_MAILBOX "mailbox"
+#define SERVER_VARIABLE "HUB_SERVER"
+#define POOL_VARIABLE "HUB_POOL"
+#define POOL_WAITING "1"
+
+#define SUITS "DHCS"
+#define SUIT_COUNT 4
+#define RANK_COUNT 16
+#define MAX_VARINT 5
+#define VARINT_BITS 7
+#define VARINT_MORE 0x80
+
 #define BASE 10
 #define CHAR_BUFFER 80
+#define READER_BUFFER 4096
 
 #define EXPECTED_ARGS 4
 
@@ -36,14 +62,122 @@ typedef struct {
     char rank;
 } Card;
 
+/**
+ * A hand held as one bit per rank for each suit, so the highest or lowest 
+ * card of a suit is a single bit scan and playing a card is constant time.
+ * 
+ * @param suits - For each suit in SUITS, bit r is set if a card of rank r 
+ *      (as encoded by encode_card) is held
+ * @param counts - How many copies of each card are held, since decks may 
+ *      repeat cards
+ */ 
+typedef struct {
+    uint16_t suits[SUIT_COUNT];
+    int counts[SUIT_COUNT][RANK_COUNT];
+} Hand;
+
+/**
+ * Reads a file descriptor in large chunks and hands out lines from a 
+ * buffer it reuses, so steady state reading allocates nothing.
+ * 
+ * @param fd - The file descriptor to read
+ * @param data - The bytes read but not yet handed out
+ * @param start - The index of the first byte not handed out
+ * @param length - The number of bytes not handed out
+ * @param capacity - The size of the buffer
+ * @param eof - Whether the end of the file has been reached
+ */ 
+typedef struct {
+    int fd;
+    char* data;
+    int start;
+    int length;
+    int capacity;
+    bool eof;
+} LineReader;
+
+/**
+ * The kinds of message sent between the hub and players. In the binary 
+ * protocol each value is also the opcode byte starting the message. WAKE 
+ * only tells a player reading a ring that there is more in it, and SEAT is 
+ * only ever sent as text.
+ */ 
+typedef enum {
+    MESSAGE_INVALID, 
+    MESSAGE_NEWROUND, 
+    MESSAGE_PLAYED, 
+    MESSAGE_GAMEOVER, 
+    MESSAGE_NEWGAME, 
+    MESSAGE_HAND, 
+    MESSAGE_PLAY, 
+    MESSAGE_WAKE, 
+    MESSAGE_SEAT
+} MessageType;
+
+/**
+ * A decoded protocol message.
+ * 
+ * @param type - What kind of message it is
+ * @param player - The lead player of NEWROUND, the player of PLAYED or 
+ * the seat of SEAT
+ * @param count - The hand size of HAND, NEWGAME and SEAT
+ * @param card - The card of PLAYED and PLAY
+ * @param cards - The cards of HAND
+ * @param players - The player count of SEAT
+ * @param threshold - The threshold of SEAT
+ * @param protocol - The protocol SEAT offers, in the line, or NULL
+ */ 
+typedef struct {
+    MessageType type;
+    int player;
+    int count;
+    Card card;
+    Card* cards;
+    int players;
+    int threshold;
+    const char* protocol;
+} Message;
+
 /* Utilities */
 char* string_of(int num, char** line);
 int read_int(char* line);
+int scan_int(const char* text, int length);
 int check_command(char* line, char* toCheck, bool matchLength);
 char* read_line(FILE* toRead, char** line);
+void init_reader(LineReader* reader, int fd);
+void free_reader(LineReader* reader);
+int fill_reader(LineReader* reader);
+char* take_line(LineReader* reader);
+char* take_bytes(LineReader* reader, int count);
+char* next_line(LineReader* reader);
 bool check_card(char* card);
-int find_max(int o1, int o2);
-int find_min(int o1, int o2);
-bool rotate_hand(Card* hand, int* handSize, Card played);
+
+/* Hands */
+int suit_index(char suit);
+int rank_index(char rank);
+void fill_hand(Hand* hand, const Card* cards, int count);
+void add_card(Hand* hand, Card card);
+bool remove_card(Hand* hand, Card card);
+bool highest_card(const Hand* hand, char suit, Card* card);
+bool lowest_card(const Hand* hand, char suit, Card* card);
+
+/* Protocol messages */
+int format_message(const Message* message, char* buffer, int size);
+MessageType parse_text(const char* line, Message* message);
+bool parse_fields(MessageType type, const char* text, Message* message);
+bool parse_seat(const char* text, int** numbers, const char** protocol);
+bool card_at(const char* text, Card* card);
+const char* next_field(const char** text, const bool* delimiters, 
+        int* length);
+
+/* Binary protocol */
+unsigned char encode_card(Card card);
+bool decode_card(unsigned char byte, Card* card);
+int put_varint(unsigned char* buffer, unsigned int value);
+int get_varint(const unsigned char* buffer, int length, int* value);
+int encoded_size(const Message* message);
+int encode_message(const Message* message, unsigned char* buffer);
+int decode_message(const unsigned char* buffer, int length, 
+        Message* message);
 
 #endif // _UTILITIES_H_
\ No newline at end of file